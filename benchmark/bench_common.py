@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""
+C++の比較スクリプト共通のヘルパー
+バイナリの場所、JSON出力の読み取り、perf stat によるハードウェアイベントの計測をまとめます
+（engine_compare.py, bitmap_sweep.py などの make ターゲットのスクリプトと runner.py が使う）。
+"""
+
+import subprocess
+import json
+import platform
+from pathlib import Path
+
+# プロジェクトルート
+ROOT_DIR = Path(__file__).parent.parent
+BIN_DIR = ROOT_DIR / "bin"
+RESULTS_DIR = ROOT_DIR / "results"
+
+EXT = ".exe" if platform.system() == "Windows" else ""
+IS_LINUX = platform.system() == "Linux"
+
+
+def run_binary(binary, args, timeout=600):
+    """バイナリを実行してJSON出力を返す（失敗したら None、timeout=None なら時間制限なし）"""
+    result = subprocess.run([str(binary)] + args,
+                          capture_output=True, text=True, timeout=timeout)
+    if result.returncode != 0:
+        return None
+    return json.loads(result.stdout)
+
+
+def measure_perf_events(command, events):
+    """perf stat でイベントごとの回数を測定（Linuxで perf が使える場合のみ、測れないイベントは0）
+
+    perf stat -x , の出力は「回数,単位,イベント名,...」の形式で、PMU が足りない・
+    対応していないイベントは回数の欄が <not counted> / <not supported> になるので読み飛ばす。
+    """
+    counts = {event: 0 for event in events}
+    if not IS_LINUX:
+        return counts
+    try:
+        result = subprocess.run(["perf", "stat", "-x", ",", "-e", ",".join(events)] + command,
+                              capture_output=True, text=True, timeout=600)
+    except (OSError, subprocess.TimeoutExpired):
+        return counts
+    for line in result.stderr.split("\n"):
+        fields = line.split(",")
+        if len(fields) > 2 and fields[2] in counts and fields[0].isdigit():
+            counts[fields[2]] = int(fields[0])
+    return counts
+
+
+def measure_cache_misses(command):
+    """キャッシュミスを測定（Linuxで perf が使える場合のみ、それ以外は0）"""
+    return measure_perf_events(command, ["cache-misses"])["cache-misses"]
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+ビットマップカーネルの解像度スイープ
+C++版の bitmap カーネルを解像度（--bitmap-bits）と huge pages の有無ごとに実行し、
+表の大きさ（L1/L2/L3/DRAM）に対する速度・ブロック版との速度比・
+キャッシュミスと TLB ミス（Linuxで perf がある場合）を並べます（make bitmap-sweep から実行）。
+"""
+
+import json
+import statistics
+import sys
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary, measure_perf_events
+
+# 1構成あたりの実行回数（中央値で比較）
+REPEATS = 3
+
+# 基準カーネルと、スイープする解像度（16KB 〜 256MB）
+BASELINE_KERNEL = "block"
+BITMAP_BITS = range(6, 16)
+
+PERF_EVENTS = ["cache-misses", "dTLB-load-misses"]
+
+
+def median_run(binary, args):
+    """REPEATS 回実行して、最後の出力に実行時間の中央値を入れて返す"""
+    times = []
+    data = None
+    for _ in range(REPEATS):
+        data = run_binary(binary, args)
+        if data:
+            times.append(data["time_ms"])
+    if not times:
+        return None
+    data["time_ms_median"] = statistics.median(times)
+    return data
+
+
+def main():
+    """メイン関数（引数はそのまま各実行に渡す。例: --engine=wyrand）"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    extra_args = sys.argv[1:]
+
+    results = []
+    print(f"{'mode':<9} {'bits':>4} {'bytes':>11} {'huge':>5} {'median ms':>10} {'speedup':>8} "
+          f"{'cache-misses':>14} {'dTLB-misses':>13}")
+
+    for mode in ["single", "parallel"]:
+        binary = BIN_DIR / f"pi_cpp_{mode}{EXT}"
+        if not binary.exists():
+            print(f"{binary.name}: Binary not found, skipping")
+            continue
+
+        baseline = median_run(binary, [f"--kernel={BASELINE_KERNEL}"] + extra_args)
+        for bits in BITMAP_BITS:
+            for huge_pages in [False, True]:
+                args = ["--kernel=bitmap", f"--bitmap-bits={bits}"] + extra_args
+                if huge_pages:
+                    args.append("--huge-pages")
+                data = median_run(binary, args)
+                if not data:
+                    print(f"{mode:<9} {bits:>4} Failed")
+                    continue
+                misses = measure_perf_events([str(binary)] + args, PERF_EVENTS)
+                entry = {
+                    "mode": mode,
+                    "engine": data["engine"],
+                    "bitmap_bits": bits,
+                    "bitmap_bytes": data["bitmap_bytes"],
+                    "huge_pages_requested": huge_pages,
+                    "huge_pages": data["huge_pages"],
+                    "time_ms_median": data["time_ms_median"],
+                    "samples_per_sec": data["iterations"] / (data["time_ms_median"] / 1000.0),
+                    "cache_misses": misses["cache-misses"],
+                    "dtlb_load_misses": misses["dTLB-load-misses"],
+                }
+                if baseline:
+                    entry["speedup"] = baseline["time_ms_median"] / entry["time_ms_median"]
+                    entry["same_count"] = data["pi_estimate"] == baseline["pi_estimate"]
+                results.append(entry)
+                print(f"{mode:<9} {bits:>4} {entry['bitmap_bytes']:>11} {str(entry['huge_pages']):>5} "
+                      f"{entry['time_ms_median']:>10.2f} {entry.get('speedup', 0.0):>8.2f} "
+                      f"{entry['cache_misses']:>14} {entry['dtlb_load_misses']:>13}")
+
+    output_file = RESULTS_DIR / "bitmap_sweep.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+数え方の比較スクリプト
+C++版のスカラー版（コンパイラ任せ）と、数え方を固定した branchy / branchless / popcount
+カーネルを同じ系列で実行し、スループット（samples/s）と分岐予測ミス
+（Linuxで perf がある場合）を並べます（make branch-compare から実行）。
+"""
+
+import json
+import statistics
+import sys
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary, measure_perf_events
+
+# 1構成あたりの実行回数（中央値で比較）
+REPEATS = 5
+
+# 比較するカーネル（scalar はコンパイラ任せの基準）
+KERNELS = ["scalar", "branchy", "branchless", "popcount"]
+
+PERF_EVENTS = ["branches", "branch-misses"]
+
+
+def main():
+    """メイン関数（引数はそのまま各実行に渡す。例: --engine=wyrand）"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    extra_args = sys.argv[1:]
+
+    results = []
+    print(f"{'mode':<9} {'kernel':<11} {'samples/s':>12} {'speedup':>8} {'branch-misses':>14} "
+          f"{'miss/sample':>12} {'same count':>11}")
+
+    for mode in ["single", "parallel"]:
+        binary = BIN_DIR / f"pi_cpp_{mode}{EXT}"
+        if not binary.exists():
+            print(f"{binary.name}: Binary not found, skipping")
+            continue
+
+        baseline = None
+        for kernel in KERNELS:
+            args = [f"--kernel={kernel}"] + extra_args
+            times = []
+            data = None
+            for _ in range(REPEATS):
+                data = run_binary(binary, args)
+                if data:
+                    times.append(data["time_ms"])
+            if not times:
+                print(f"{mode:<9} {kernel:<11} Failed")
+                continue
+            median_ms = statistics.median(times)
+            counts = measure_perf_events([str(binary)] + args, PERF_EVENTS)
+            entry = {
+                "mode": mode,
+                "kernel": kernel,
+                "engine": data["engine"],
+                "time_ms_median": median_ms,
+                "samples_per_sec": data["iterations"] / (median_ms / 1000.0),
+                "branches": counts["branches"],
+                "branch_misses": counts["branch-misses"],
+                "branch_misses_per_sample": counts["branch-misses"] / data["iterations"],
+                "pi_estimate": data["pi_estimate"],
+            }
+            if baseline is None:
+                baseline = entry
+            entry["speedup"] = baseline["time_ms_median"] / median_ms
+            entry["same_count"] = entry["pi_estimate"] == baseline["pi_estimate"]
+            results.append(entry)
+            print(f"{mode:<9} {kernel:<11} {entry['samples_per_sec']:>12.4g} {entry['speedup']:>8.2f} "
+                  f"{entry['branch_misses']:>14} {entry['branch_misses_per_sample']:>12.4f} "
+                  f"{str(entry['same_count']):>11}")
+
+    output_file = RESULTS_DIR / "branch_compare.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""
+乱数エンジン比較スクリプト
+C++版のエンジンレジストリに登録された全エンジンを同じカーネルで実行し、
+スループット（samples/s）・誤差・キャッシュミス数（Linuxで perf がある場合）を
+並べて比較します（make engine-compare から実行）。
+"""
+
+import subprocess
+import json
+import sys
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary, measure_cache_misses
+
+
+def list_engines(binary):
+    """バイナリに登録されているエンジン名を取得"""
+    result = subprocess.run([str(binary), "--list-engines"],
+                          capture_output=True, text=True, timeout=10)
+    return result.stdout.split()
+
+
+def main():
+    """メイン関数（引数はそのまま各実行に渡す。例: --kernel=block）"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    extra_args = sys.argv[1:]
+    
+    results = []
+    print(f"{'mode':<9} {'engine':<14} {'samples/s':>14} {'error':>12} {'cache-misses':>14}")
+    
+    for mode in ["single", "parallel"]:
+        binary = BIN_DIR / f"pi_cpp_{mode}{EXT}"
+        if not binary.exists():
+            print(f"{binary.name}: Binary not found, skipping")
+            continue
+        
+        for engine in list_engines(binary):
+            args = [f"--engine={engine}"] + extra_args
+            data = run_binary(binary, args)
+            if not data:
+                print(f"{mode:<9} {engine:<14} Failed")
+                continue
+            data["cache_misses"] = measure_cache_misses([str(binary)] + args)
+            results.append(data)
+            print(f"{mode:<9} {engine:<14} {data['samples_per_sec']:>14.4g} {data['error']:>12.3e} "
+                  f"{data['cache_misses']:>14}")
+    
+    output_file = RESULTS_DIR / "engine_compare.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+    
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+単精度版の誤差比較スクリプト
+C++並列版の倍精度パス（block カーネル）と単精度パス（float カーネル）を
+10^8 〜 10^11 サンプルで実行し、誤差・標準誤差・スループットを並べます
+（make float-error から実行）。
+
+単精度パスの系統誤差（格子と float の丸め、推定値から差し引き済み）は約 4.3e-7 で、
+誤差が標準誤差 sqrt(π(4 - π) / n) と同程度に収まっていれば、
+精度を落としても推定値の質は変わらないことになります。
+"""
+
+import json
+import math
+import sys
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary
+
+# 試行回数 10^MIN_EXPONENT 〜 10^MAX_EXPONENT（--max-exp=N で上限を変更）
+MIN_EXPONENT = 8
+MAX_EXPONENT = 11
+
+# 倍精度パスと単精度パス
+DOUBLE_KERNEL = "block"
+FLOAT_KERNEL = "float"
+
+
+def main():
+    """メイン関数（--max-exp=N 以外の引数はそのまま各実行に渡す。例: --engine=wyrand）"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    max_exponent = MAX_EXPONENT
+    extra_args = []
+    for arg in sys.argv[1:]:
+        if arg.startswith("--max-exp="):
+            max_exponent = int(arg.split("=", 1)[1])
+        else:
+            extra_args.append(arg)
+
+    binary = BIN_DIR / f"pi_cpp_parallel{EXT}"
+    if not binary.exists():
+        print(f"{binary.name}: Binary not found")
+        return
+
+    results = []
+    print(f"{'samples':>8} {'kernel':<7} {'error':>12} {'std err':>12} {'err/se':>7} "
+          f"{'samples/s':>12} {'speedup':>8}")
+
+    for exponent in range(MIN_EXPONENT, max_exponent + 1):
+        iterations = 10 ** exponent
+        std_err = math.sqrt(math.pi * (4 - math.pi) / iterations)
+        entries = {}
+        for kernel in [DOUBLE_KERNEL, FLOAT_KERNEL]:
+            # 10^11 サンプルは数分かかるので時間制限なし
+            data = run_binary(binary, [f"--kernel={kernel}", f"--iterations={iterations}"] + extra_args,
+                              timeout=None)
+            if not data:
+                print(f"{'1e' + str(exponent):>8} {kernel:<7} Failed")
+                continue
+            entries[kernel] = {
+                "iterations": iterations,
+                "kernel": kernel,
+                "engine": data["engine"],
+                "float_lanes": data.get("float_lanes"),
+                "pi_estimate": data["pi_estimate"],
+                "error": data["error"],
+                "std_err": std_err,
+                "error_over_std_err": data["error"] / std_err,
+                "time_ms": data["time_ms"],
+                "samples_per_sec": data["samples_per_sec"],
+            }
+
+        baseline = entries.get(DOUBLE_KERNEL)
+        for kernel, entry in entries.items():
+            if baseline:
+                entry["speedup"] = baseline["time_ms"] / entry["time_ms"]
+                entry["diff_from_double"] = entry["pi_estimate"] - baseline["pi_estimate"]
+            results.append(entry)
+            print(f"{'1e' + str(exponent):>8} {kernel:<7} {entry['error']:>12.3e} {std_err:>12.3e} "
+                  f"{entry['error_over_std_err']:>7.2f} {entry['samples_per_sec']:>12.4g} "
+                  f"{entry.get('speedup', 0.0):>8.2f}")
+
+    output_file = RESULTS_DIR / "float_error.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+多系列インターリーブ版のスイープ
+C++版のスカラー版（K = 1）と interleave2/4/8 カーネルを、通常ビルドと
+-march=native なしのビルド（AVXなし）で実行し、1サンプルあたりの時間（ns/sample）と
+スカラー版に対する速度比を並べます（make interleave-sweep から実行）。
+"""
+
+import json
+import statistics
+import sys
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary
+
+# 1構成あたりの実行回数（中央値で比較）
+REPEATS = 5
+
+# 系列数 K とカーネル名（K = 1 がスカラー版）
+KERNELS = [(1, "scalar"), (2, "interleave2"), (4, "interleave4"), (8, "interleave8")]
+
+# 比較するバイナリ（_portable は make build-cpp-portable でビルド）
+BINARIES = ["pi_cpp_single", "pi_cpp_parallel", "pi_cpp_single_portable"]
+
+
+def main():
+    """メイン関数（引数はそのまま各実行に渡す。例: --engine=pcg64）"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    extra_args = sys.argv[1:]
+
+    results = []
+    print(f"{'binary':<24} {'K':>2} {'ns/sample':>10} {'speedup':>8} {'same count':>11}")
+
+    for name in BINARIES:
+        binary = BIN_DIR / f"{name}{EXT}"
+        if not binary.exists():
+            print(f"{binary.name}: Binary not found, skipping")
+            continue
+
+        baseline = None
+        for k, kernel in KERNELS:
+            args = [f"--kernel={kernel}"] + extra_args
+            times = []
+            data = None
+            for _ in range(REPEATS):
+                data = run_binary(binary, args)
+                if data:
+                    times.append(data["time_ms"])
+            if not times:
+                print(f"{binary.name:<24} {k:>2} Failed")
+                continue
+            median_ms = statistics.median(times)
+            entry = {
+                "binary": binary.name,
+                "compiler_flags": data["compiler_flags"],
+                "engine": data["engine"],
+                "streams": k,
+                "kernel": kernel,
+                "time_ms_median": median_ms,
+                "ns_per_sample": median_ms * 1e6 / data["iterations"],
+                "pi_estimate": data["pi_estimate"],
+            }
+            if baseline is None:
+                baseline = entry
+            entry["speedup"] = baseline["time_ms_median"] / median_ms
+            entry["same_count"] = entry["pi_estimate"] == baseline["pi_estimate"]
+            results.append(entry)
+            print(f"{binary.name:<24} {k:>2} {entry['ns_per_sample']:>10.3f} "
+                  f"{entry['speedup']:>8.2f} {str(entry['same_count']):>11}")
+
+    output_file = RESULTS_DIR / "interleave_sweep.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+カーネル比較スクリプト
+C++版の各カーネルを同じエンジン・同じ系列で実行し、基準カーネルに対する
+速度比と、推定値が基準と一致するか（同じ点数を数えているか）を比較します
+（make kernel-compare から実行）。
+"""
+
+import json
+import statistics
+import sys
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary
+
+# 1構成あたりの実行回数（中央値で比較）
+REPEATS = 5
+
+# 基準カーネルと、それと同じ点数になるはずのカーネル
+BASELINE_KERNEL = "block"
+KERNELS = ["scalar", "block", "earlyout8", "earlyout10", "earlyout12"]
+
+
+def main():
+    """メイン関数（引数はそのまま各実行に渡す。例: --engine=wyrand）"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    extra_args = sys.argv[1:]
+
+    results = []
+    print(f"{'mode':<9} {'kernel':<12} {'median ms':>10} {'speedup':>8} {'same count':>11}")
+
+    for mode in ["single", "parallel"]:
+        binary = BIN_DIR / f"pi_cpp_{mode}{EXT}"
+        if not binary.exists():
+            print(f"{binary.name}: Binary not found, skipping")
+            continue
+
+        entries = {}
+        for kernel in KERNELS:
+            args = [f"--kernel={kernel}"] + extra_args
+            times = []
+            data = None
+            for _ in range(REPEATS):
+                data = run_binary(binary, args)
+                if data:
+                    times.append(data["time_ms"])
+            if not times:
+                print(f"{mode:<9} {kernel:<12} Failed")
+                continue
+            entries[kernel] = {
+                "mode": mode,
+                "kernel": kernel,
+                "engine": data["engine"],
+                "time_ms_median": statistics.median(times),
+                "time_ms_min": min(times),
+                "pi_estimate": data["pi_estimate"],
+            }
+
+        baseline = entries.get(BASELINE_KERNEL)
+        for kernel, entry in entries.items():
+            if baseline:
+                entry["speedup"] = baseline["time_ms_median"] / entry["time_ms_median"]
+                entry["same_count"] = entry["pi_estimate"] == baseline["pi_estimate"]
+            results.append(entry)
+            print(f"{mode:<9} {kernel:<12} {entry['time_ms_median']:>10.2f} "
+                  f"{entry.get('speedup', 0.0):>8.2f} {str(entry.get('same_count', '-')):>11}")
+
+    output_file = RESULTS_DIR / "kernel_compare.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""
+LTO比較スクリプト
+C++版をLTOあり（-flto）となしでビルドしたバイナリを交互に実行し、
+実行時間を比較します（make lto-compare から実行）。
+"""
+
+import json
+import statistics
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary
+
+# 1構成あたりの実行回数（中央値で比較）
+REPEATS = 5
+
+# 比較するカーネル（スカラー版とブロック版）
+KERNEL_ARGS = [[], ["--kernel=block"]]
+
+
+def main():
+    """メイン関数"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    
+    results = []
+    print(f"{'binary':<26} {'args':<16} {'median ms':>10} {'min ms':>10}")
+    
+    for mode in ["single", "parallel"]:
+        for args in KERNEL_ARGS:
+            for suffix in ["", "_nolto"]:
+                binary = BIN_DIR / f"pi_cpp_{mode}{suffix}{EXT}"
+                if not binary.exists():
+                    print(f"{binary.name}: Binary not found, skipping")
+                    continue
+                
+                times = []
+                data = None
+                for _ in range(REPEATS):
+                    data = run_binary(binary, args)
+                    if data:
+                        times.append(data["time_ms"])
+                if not times:
+                    print(f"{binary.name}: Failed")
+                    continue
+                
+                entry = {
+                    "binary": binary.name,
+                    "mode": mode,
+                    "args": args,
+                    "compiler_flags": data["compiler_flags"],
+                    "time_ms_median": statistics.median(times),
+                    "time_ms_min": min(times),
+                    "pi_estimate": data["pi_estimate"],
+                }
+                results.append(entry)
+                print(f"{binary.name:<26} {' '.join(args):<16} "
+                      f"{entry['time_ms_median']:>10.2f} {entry['time_ms_min']:>10.2f}")
+    
+    output_file = RESULTS_DIR / "lto_compare.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+    
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+目標精度モードの比較スクリプト
+C++並列版を --precision（信頼区間の半幅の目標）で推定量ごとに実行し、
+止まるまでに使った試行回数と壁時計の時間、目標に達したかを並べます
+（make precision-target から実行）。
+
+試行回数は分散 × (z / 半幅)^2 で決まるので、分散の小さい推定量ほど少ないサンプルで止まります。
+誤差（理論値との差）が半幅以内に収まっているかも記録します（99% なら大半の実行で収まるはず）。
+"""
+
+import json
+import sys
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary
+
+# 信頼区間の半幅の目標（--min-precision=H で最も細かい目標を変更）
+PRECISIONS = [1e-3, 3e-4, 1e-4]
+
+# 信頼水準
+CONFIDENCE = 99
+
+# 比較する推定量（カーネルは block）
+ESTIMATORS = ["hitmiss", "antithetic", "control"]
+
+
+def main():
+    """メイン関数（--min-precision=H 以外の引数はそのまま各実行に渡す。例: --engine=wyrand）"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    min_precision = PRECISIONS[-1]
+    extra_args = []
+    for arg in sys.argv[1:]:
+        if arg.startswith("--min-precision="):
+            min_precision = float(arg.split("=", 1)[1])
+        else:
+            extra_args.append(arg)
+    precisions = [p for p in PRECISIONS if p >= min_precision]
+    if min_precision not in precisions:
+        precisions.append(min_precision)
+
+    binary = BIN_DIR / f"pi_cpp_parallel{EXT}"
+    if not binary.exists():
+        print(f"{binary.name}: Binary not found")
+        return
+
+    results = []
+    print(f"{'target':>8} {'estimator':<11} {'samples':>14} {'time ms':>10} {'half width':>12} "
+          f"{'error':>12} {'covered':>8}")
+
+    for precision in precisions:
+        for estimator in ESTIMATORS:
+            args = ["--kernel=block", f"--estimator={estimator}", f"--precision={precision}",
+                    f"--confidence={CONFIDENCE}"] + extra_args
+            # 試行回数が目標で決まるので時間制限なし
+            data = run_binary(binary, args, timeout=None)
+            if not data:
+                print(f"{precision:>8.0e} {estimator:<11} Failed")
+                continue
+            entry = {
+                "target_precision": precision,
+                "confidence": CONFIDENCE,
+                "estimator": estimator,
+                "engine": data["engine"],
+                "pi_estimate": data["pi_estimate"],
+                "error": data["error"],
+                "half_width": data["half_width"],
+                "converged": data["converged"],
+                "samples_used": data["samples_used"],
+                "time_ms": data["time_ms"],
+                "covered": data["error"] <= data["half_width"],
+            }
+            results.append(entry)
+            print(f"{precision:>8.0e} {estimator:<11} {entry['samples_used']:>14} {entry['time_ms']:>10.1f} "
+                  f"{entry['half_width']:>12.3e} {entry['error']:>12.3e} "
+                  f"{'yes' if entry['covered'] else 'no':>8}"
+                  f"{'' if entry['converged'] else ' (max iterations)'}")
+
+    output_file = RESULTS_DIR / "precision_target.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
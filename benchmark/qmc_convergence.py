@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+準モンテカルロの収束比較スクリプト
+C++並列版を乱数列（xoshiro256ss）と2次元 Sobol 列（sobol2d）・R2 列（r2）で 10^4 〜 10^8 サンプル実行し、
+シードを変えた複製（--scrambles）のばらつきから求めた標準誤差を並べます
+（make qmc-convergence から実行）。
+
+乱数列の標準誤差は N^(-1/2) で減り、低食い違い列はそれより速く減るので、
+同じ標準誤差に必要なサンプル数の比（分散の比）がサンプル数とともに大きくなります。
+"""
+
+import json
+import math
+import sys
+
+from bench_common import BIN_DIR, RESULTS_DIR, EXT, run_binary
+
+# 試行回数 10^MIN_EXPONENT 〜 10^MAX_EXPONENT（--max-exp=N で上限を変更）
+MIN_EXPONENT = 4
+MAX_EXPONENT = 8
+
+# 1構成あたりの複製数（標準誤差の見積もりに使う）
+SCRAMBLES = 16
+
+# 比較するエンジン（先頭が基準の乱数列）
+ENGINES = ["xoshiro256ss", "sobol2d", "r2"]
+
+
+def main():
+    """メイン関数（--max-exp=N 以外の引数はそのまま各実行に渡す。例: --kernel=block）"""
+    RESULTS_DIR.mkdir(exist_ok=True)
+    max_exponent = MAX_EXPONENT
+    extra_args = []
+    for arg in sys.argv[1:]:
+        if arg.startswith("--max-exp="):
+            max_exponent = int(arg.split("=", 1)[1])
+        else:
+            extra_args.append(arg)
+
+    binary = BIN_DIR / f"pi_cpp_parallel{EXT}"
+    if not binary.exists():
+        print(f"{binary.name}: Binary not found")
+        return
+
+    results = []
+    print(f"{'samples':>8} {'engine':<13} {'error':>12} {'std err':>12} {'se*sqrt(n)':>11} "
+          f"{'variance gain':>14} {'samples/s':>12}")
+
+    for exponent in range(MIN_EXPONENT, max_exponent + 1):
+        iterations = 10 ** exponent
+        baseline = None
+        for engine in ENGINES:
+            args = [f"--engine={engine}", f"--iterations={iterations}",
+                    f"--scrambles={SCRAMBLES}"] + extra_args
+            data = run_binary(binary, args)
+            if not data:
+                print(f"{'1e' + str(exponent):>8} {engine:<13} Failed")
+                continue
+            std_err = data["scramble_std_error"]
+            entry = {
+                "iterations": iterations,
+                "scrambles": SCRAMBLES,
+                "engine": engine,
+                "pi_estimate": data["pi_estimate"],
+                "error": data["error"],
+                "scramble_std_error": std_err,
+                # 1本あたりの標準誤差 × sqrt(n)（乱数列なら一定、小さくなるほど収束が速い）
+                "scaled_std_error": std_err * math.sqrt(SCRAMBLES * iterations),
+                "time_ms": data["time_ms"],
+                "samples_per_sec": data["samples_per_sec"],
+            }
+            if baseline is None:
+                baseline = entry
+            entry["variance_gain"] = (baseline["scramble_std_error"] / std_err) ** 2 if std_err > 0 else 0.0
+            results.append(entry)
+            print(f"{'1e' + str(exponent):>8} {engine:<13} {entry['error']:>12.3e} {std_err:>12.3e} "
+                  f"{entry['scaled_std_error']:>11.4f} {entry['variance_gain']:>14.4g} "
+                  f"{entry['samples_per_sec']:>12.4g}")
+
+    output_file = RESULTS_DIR / "qmc_convergence.json"
+    with open(output_file, "w") as f:
+        json.dump(results, f, indent=2)
+
+    print(f"\nResults saved to {output_file}")
+
+
+if __name__ == "__main__":
+    main()
@@ -14,6 +14,8 @@ import time
 import shutil
 from pathlib import Path
 
+from bench_common import measure_cache_misses
+
 # プロジェクトルート
 ROOT_DIR = Path(__file__).parent.parent
 BIN_DIR = ROOT_DIR / "bin"
@@ -24,6 +26,17 @@ RESULTS_DIR = ROOT_DIR / "results"
 ITERATIONS = 100_000_000
 WARMUP_ITERATIONS = 1_000_000
 
+# C++の追加計測（カーネル等のバリエーション）
+CPP_EXTRA_RUNS = [
+    ("single", ["--kernel=simd"]),
+    ("single", ["--kernel=block"]),
+    ("parallel", ["--kernel=block"]),
+    ("single", ["--kernel=int32"]),
+    ("parallel", ["--kernel=int32"]),
+    ("single", ["--kernel=int16"]),
+    ("parallel", ["--kernel=int16"]),
+]
+
 # JIT言語のリスト
 JIT_LANGUAGES = ["julia", "java", "javascript"]
 
@@ -83,24 +96,6 @@ def measure_memory_linux(command):
     return 0.0
 
 
-def measure_cache_misses(command):
-    """キャッシュミスを測定（Linuxのみ）"""
-    if not IS_LINUX:
-        return 0
-    
-    try:
-        result = subprocess.run(["perf", "stat", "-e", "cache-misses"] + command,
-                              capture_output=True, text=True, timeout=600)
-        for line in result.stderr.split("\n"):
-            if "cache-misses" in line:
-                parts = line.split()
-                if len(parts) > 0:
-                    return int(parts[0].replace(",", ""))
-    except:
-        pass
-    return 0
-
-
 def run_python_standard(mode):
     """Python Standard版を実行"""
     script = ROOT_DIR / "python" / "standard" / f"monte_carlo_{mode}.py"
@@ -402,16 +397,18 @@ def run_rust(mode):
     return None
 
 
-def run_cpp(mode):
-    """C++版を実行"""
+def run_cpp(mode, args=None):
+    """C++版を実行（argsでカーネル等のオプションを指定）"""
+    args = args or []
     binary = BIN_DIR / f"pi_cpp_{mode}{'.exe' if IS_WINDOWS else ''}"
     if not binary.exists():
         print(f"    C++ ({mode}): Binary not found, skipping")
         return None
     
-    print(f"    Running C++ ({mode})...", end="", flush=True)
+    label = f"{mode}{' ' + ' '.join(args) if args else ''}"
+    print(f"    Running C++ ({label})...", end="", flush=True)
     start_time = time.time()
-    result = subprocess.run([str(binary)],
+    result = subprocess.run([str(binary)] + args,
                           capture_output=True, text=True, timeout=600)
     elapsed = time.time() - start_time
     if result.returncode == 0:
@@ -499,6 +496,11 @@ def main():
         if result:
             result["cpu_model"] = cpu_model
             results.append(result)
+    for mode, args in CPP_EXTRA_RUNS:
+        result = run_cpp(mode, args)
+        if result:
+            result["cpu_model"] = cpu_model
+            results.append(result)
     
     print("Rust:")
     for mode in ["single", "parallel"]:
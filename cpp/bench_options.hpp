@@ -0,0 +1,674 @@
+#ifndef BENCH_OPTIONS_HPP
+#define BENCH_OPTIONS_HPP
+
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "engine_registry.hpp"
+
+// 正規分布の両側 95% / 99% 点
+constexpr double Z_95 = 1.959963984540054;
+constexpr double Z_99 = 2.5758293035489004;
+
+/**
+ * 信頼水準（95 か 99）の正規分布の両側点
+ */
+inline double confidence_z(int confidence) {
+    return (confidence == 95) ? Z_95 : Z_99;
+}
+
+/**
+ * 自由度 dof の t 分布の両側 95% / 99% 点（複製の数が少ないときの信頼区間）
+ * 
+ * dof <= 30 は表の値、それより大きければ正規分布の点からの Cornish-Fisher 展開
+ * （Abramowitz & Stegun 26.7.5、dof > 30 で誤差 1e-6 未満）
+ */
+inline double student_t_quantile(int confidence, uint64_t dof) {
+    static const double T_95[30] = {
+        12.7062, 4.3027, 3.1824, 2.7764, 2.5706, 2.4469, 2.3646, 2.3060, 2.2622, 2.2281,
+        2.2010, 2.1788, 2.1604, 2.1448, 2.1314, 2.1199, 2.1098, 2.1009, 2.0930, 2.0860,
+        2.0796, 2.0739, 2.0687, 2.0639, 2.0595, 2.0555, 2.0518, 2.0484, 2.0452, 2.0423,
+    };
+    static const double T_99[30] = {
+        63.6567, 9.9248, 5.8409, 4.6041, 4.0321, 3.7074, 3.4995, 3.3554, 3.2498, 3.1693,
+        3.1058, 3.0545, 3.0123, 2.9768, 2.9467, 2.9208, 2.8982, 2.8784, 2.8609, 2.8453,
+        2.8314, 2.8188, 2.8073, 2.7969, 2.7874, 2.7787, 2.7707, 2.7633, 2.7564, 2.7500,
+    };
+    if (dof >= 1 && dof <= 30) return (confidence == 95) ? T_95[dof - 1] : T_99[dof - 1];
+    double z = confidence_z(confidence);
+    double v = (double)dof;
+    double z2 = z * z;
+    return z + z * (z2 + 1.0) / (4.0 * v) + z * ((5.0 * z2 + 16.0) * z2 + 3.0) / (96.0 * v * v) +
+           z * (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) / (384.0 * v * v * v) +
+           z * ((((79.0 * z2 + 776.0) * z2 + 1482.0) * z2 - 1920.0) * z2 - 945.0) / (92160.0 * v * v * v * v);
+}
+
+/**
+ * コマンドライン引数（シングルスレッド版・並列版で共通）
+ * 
+ * --engine=NAME    乱数エンジン（既定: xoshiro256ss）
+ * --kernel=NAME    カーネル（scalar, block, branchy, branchless, popcount, interleave2,
+ *                  interleave4, interleave8, int32, int26, int21, int16, float, earlyout8,
+ *                  earlyout10, earlyout12, bitmap, シングルスレッド版のみ simd）
+ * --iterations=N   試行回数（既定: 100000000、他言語と同条件）
+ * --estimator=NAME 推定量（hitmiss, conditional, antithetic, stratified, control、estimators.hpp）。hitmiss 以外では
+ *                  --kernel のカーネルの当たり外れも同じ試行回数で実行し、比較を出力する
+ * --strata=S       stratified の1軸あたりの分割数（既定: 0 = 境界セルの点数の合計が --iterations
+ *                  程度になる S、指定すると試行回数は境界セルの数 × m で決まる）
+ * --samples-per-cell=M stratified の境界セル1つあたりの点数（既定: 16、2以上）
+ * --control-sides=N control の制御変量に使う内接正 N 角形（4, 8, 16, 32, 64、既定: 64）
+ * --scrambles=R    シードを変えた R 本の独立な複製を実行し、推定値の平均と複製間のばらつきによる
+ *                  標準誤差を出す（既定: 1、sobol2d ではスクランブルの違う複製）
+ * --target-error=E 推定量の比較で「標準誤差 E に達するまでの時間」を求める E（既定: 1e-5）
+ * --precision=H   並列版のみ。信頼区間の半幅が H 以下になるまでチャンク単位で続けて止める
+ *                  （既定: 0 = 無効、--iterations の代わりに --max-iterations が上限）
+ * --confidence=C   --precision の信頼水準（95 か 99、既定: 99）
+ * --max-iterations=N --precision で打ち切る試行回数の上限（既定: 10^12）
+ * --bitmap-bits=N  bitmap カーネルの1軸あたりの解像度（既定: 12、表は 4^N / 4 バイト）
+ * --huge-pages     bitmap カーネルの表に Transparent Huge Pages を使う（Linux のみ）
+ * --list-engines   登録されているエンジン名を表示して終了
+ */
+struct BenchOptions {
+    static constexpr int MAX_SCRAMBLES = 1024;
+    static constexpr uint64_t DEFAULT_MAX_ITERATIONS = 1000000000000ULL;
+
+    std::string engine = "xoshiro256ss";
+    std::string kernel = "scalar";
+    uint64_t iterations = 100000000ULL;
+    std::string estimator = "hitmiss";
+    uint64_t strata = 0;
+    uint64_t samples_per_cell = 16;
+    int scrambles = 1;
+    int control_sides = 64;
+    double target_error = 1e-5;
+    double precision = 0.0;
+    int confidence = 99;
+    uint64_t max_iterations = BenchOptions::DEFAULT_MAX_ITERATIONS;
+    int bitmap_bits = 12;
+    bool huge_pages = false;
+    bool list_engines = false;
+};
+
+/**
+ * "--key=value" 形式の引数から value を取り出す
+ */
+inline bool match_option(const char *arg, const char *key, std::string &value) {
+    size_t len = std::strlen(key);
+    if (std::strncmp(arg, key, len) != 0 || arg[len] != '=') return false;
+    value = arg + len + 1;
+    return true;
+}
+
+/**
+ * 整数の値を解析（範囲外・数値でなければ false）
+ */
+inline bool parse_int(const std::string &text, int min_value, int max_value, int &value) {
+    char *end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || parsed < min_value || parsed > max_value) return false;
+    value = (int)parsed;
+    return true;
+}
+
+/**
+ * 正の64ビット整数の値を解析（0・数値でなければ false）
+ */
+inline bool parse_count(const std::string &text, uint64_t &value) {
+    char *end = nullptr;
+    unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+    if (text.empty() || text[0] == '-' || *end != '\0' || parsed == 0) return false;
+    value = (uint64_t)parsed;
+    return true;
+}
+
+/**
+ * 正の実数の値を解析（0以下・数値でなければ false）
+ */
+inline bool parse_positive(const std::string &text, double &value) {
+    char *end = nullptr;
+    double parsed = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !(parsed > 0.0)) return false;
+    value = parsed;
+    return true;
+}
+
+/**
+ * 引数を解析（不正な引数はエラーメッセージを stderr に出して false）
+ */
+inline bool parse_options(int argc, char *argv[], BenchOptions &options) {
+    std::string value;
+    for (int i = 1; i < argc; i++) {
+        if (match_option(argv[i], "--engine", options.engine)) continue;
+        if (match_option(argv[i], "--kernel", options.kernel)) continue;
+        if (match_option(argv[i], "--iterations", value)) {
+            if (!parse_count(value, options.iterations)) {
+                std::cerr << "--iterations must be a positive integer\n";
+                return false;
+            }
+            continue;
+        }
+        if (match_option(argv[i], "--estimator", options.estimator)) continue;
+        if (match_option(argv[i], "--strata", value)) {
+            if (!parse_count(value, options.strata) || options.strata > StrataLayout::MAX_STRATA) {
+                std::cerr << "--strata must be 1.." << StrataLayout::MAX_STRATA << "\n";
+                return false;
+            }
+            continue;
+        }
+        if (match_option(argv[i], "--samples-per-cell", value)) {
+            if (!parse_count(value, options.samples_per_cell) || options.samples_per_cell < 2 ||
+                options.samples_per_cell > StrataLayout::MAX_SAMPLES_PER_CELL) {
+                std::cerr << "--samples-per-cell must be 2.." << StrataLayout::MAX_SAMPLES_PER_CELL << "\n";
+                return false;
+            }
+            continue;
+        }
+        if (match_option(argv[i], "--control-sides", value)) {
+            int sides = 0;
+            if (!parse_int(value, 4, 4 * ControlPolygon::MAX_EDGES, sides) || (sides & (sides - 1)) != 0) {
+                std::cerr << "--control-sides must be 4, 8, 16, 32 or 64\n";
+                return false;
+            }
+            options.control_sides = sides;
+            continue;
+        }
+        if (match_option(argv[i], "--scrambles", value)) {
+            if (!parse_int(value, 1, BenchOptions::MAX_SCRAMBLES, options.scrambles)) {
+                std::cerr << "--scrambles must be 1.." << BenchOptions::MAX_SCRAMBLES << "\n";
+                return false;
+            }
+            continue;
+        }
+        if (match_option(argv[i], "--target-error", value)) {
+            if (!parse_positive(value, options.target_error)) {
+                std::cerr << "--target-error must be a positive number\n";
+                return false;
+            }
+            continue;
+        }
+        if (match_option(argv[i], "--precision", value)) {
+            if (!parse_positive(value, options.precision)) {
+                std::cerr << "--precision must be a positive number\n";
+                return false;
+            }
+            continue;
+        }
+        if (match_option(argv[i], "--confidence", value)) {
+            if (!parse_int(value, 95, 99, options.confidence) ||
+                (options.confidence != 95 && options.confidence != 99)) {
+                std::cerr << "--confidence must be 95 or 99\n";
+                return false;
+            }
+            continue;
+        }
+        if (match_option(argv[i], "--max-iterations", value)) {
+            if (!parse_count(value, options.max_iterations)) {
+                std::cerr << "--max-iterations must be a positive integer\n";
+                return false;
+            }
+            continue;
+        }
+        if (match_option(argv[i], "--bitmap-bits", value)) {
+            if (!parse_int(value, CellBitmap::MIN_BITS, CellBitmap::MAX_BITS, options.bitmap_bits)) {
+                std::cerr << "--bitmap-bits must be " << CellBitmap::MIN_BITS << ".."
+                          << CellBitmap::MAX_BITS << "\n";
+                return false;
+            }
+            continue;
+        }
+        if (std::strcmp(argv[i], "--huge-pages") == 0) {
+            options.huge_pages = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--list-engines") == 0) {
+            options.list_engines = true;
+            continue;
+        }
+        std::cerr << "Unknown option: " << argv[i] << "\n";
+        return false;
+    }
+    if (!find_engine(options.engine.c_str())) {
+        std::cerr << "Unknown engine: " << options.engine << " (see --list-engines)\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * エンジン名の一覧を表示
+ */
+inline void print_engines() {
+    for (const EngineEntry &entry : ENGINE_REGISTRY) {
+        std::cout << entry.name << "\n";
+    }
+}
+
+/**
+ * カーネル名を Kernel に変換（不明な名前は false）
+ */
+inline bool parse_kernel(const std::string &name, Kernel &kernel) {
+    if (name == "scalar") {
+        kernel = Kernel::Scalar;
+    } else if (name == "block") {
+        kernel = Kernel::Block;
+    } else if (name == "branchy") {
+        kernel = Kernel::Branchy;
+    } else if (name == "branchless") {
+        kernel = Kernel::Branchless;
+    } else if (name == "popcount") {
+        kernel = Kernel::Popcount;
+    } else if (name == "interleave2") {
+        kernel = Kernel::Interleave2;
+    } else if (name == "interleave4") {
+        kernel = Kernel::Interleave4;
+    } else if (name == "interleave8") {
+        kernel = Kernel::Interleave8;
+    } else if (name == "int32") {
+        kernel = Kernel::Int32;
+    } else if (name == "int26") {
+        kernel = Kernel::Int26;
+    } else if (name == "int21") {
+        kernel = Kernel::Int21;
+    } else if (name == "int16") {
+        kernel = Kernel::Int16;
+    } else if (name == "float") {
+        kernel = Kernel::Float;
+    } else if (name == "earlyout8") {
+        kernel = Kernel::EarlyOut8;
+    } else if (name == "earlyout10") {
+        kernel = Kernel::EarlyOut10;
+    } else if (name == "earlyout12") {
+        kernel = Kernel::EarlyOut12;
+    } else if (name == "bitmap") {
+        kernel = Kernel::Bitmap;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * JSON の variant に出す名前
+ */
+inline const char *kernel_variant(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Block:
+        return "block";
+    case Kernel::Branchy:
+        return "branchy";
+    case Kernel::Branchless:
+        return "branchless";
+    case Kernel::Popcount:
+        return "popcount";
+    case Kernel::Interleave2:
+        return "interleave2";
+    case Kernel::Interleave4:
+        return "interleave4";
+    case Kernel::Interleave8:
+        return "interleave8";
+    case Kernel::Int32:
+        return "int32";
+    case Kernel::Int26:
+        return "int26";
+    case Kernel::Int21:
+        return "int21";
+    case Kernel::Int16:
+        return "int16";
+    case Kernel::Float:
+        return "float";
+    case Kernel::EarlyOut8:
+        return "earlyout8";
+    case Kernel::EarlyOut10:
+        return "earlyout10";
+    case Kernel::EarlyOut12:
+        return "earlyout12";
+    case Kernel::Bitmap:
+        return "bitmap";
+    case Kernel::Scalar:
+    default:
+        return "standard";
+    }
+}
+
+/**
+ * 推定量の名前を Estimator に変換（不明な名前は false）
+ */
+inline bool parse_estimator(const std::string &name, Estimator &estimator) {
+    if (name == "hitmiss") {
+        estimator = Estimator::HitMiss;
+    } else if (name == "conditional") {
+        estimator = Estimator::Conditional;
+    } else if (name == "antithetic") {
+        estimator = Estimator::Antithetic;
+    } else if (name == "stratified") {
+        estimator = Estimator::Stratified;
+    } else if (name == "control") {
+        estimator = Estimator::ControlVariate;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * JSON の estimator に出す名前
+ */
+inline const char *estimator_name(Estimator estimator) {
+    switch (estimator) {
+    case Estimator::Conditional:
+        return "conditional";
+    case Estimator::Antithetic:
+        return "antithetic";
+    case Estimator::Stratified:
+        return "stratified";
+    case Estimator::ControlVariate:
+        return "control";
+    case Estimator::HitMiss:
+    default:
+        return "hitmiss";
+    }
+}
+
+/**
+ * エンジンとカーネルの組み合わせを確認（使えなければ stderr に出して false）
+ * 
+ * 整数版・単精度版カーネルは next() の下位ビットから座標を切り出すので、
+ * 乱数が上位52ビットしかない dSFMT では下位12ビットが常に0の座標ができる
+ */
+inline bool check_kernel_engine(Kernel kernel, const EngineEntry &engine) {
+    if (kernel_uses_raw_words(kernel) && engine.output_bits < 64) {
+        std::cerr << "--kernel=" << kernel_variant(kernel) << " needs 64 random bits per draw (" << engine.name << " has "
+                  << engine.output_bits << ")\n";
+        return false;
+    }
+    if (kernel_uses_raw_words(kernel) && engine.point_pairs) {
+        std::cerr << "--kernel=" << kernel_variant(kernel) << " splits one draw into several coordinates, which "
+                  << engine.name << " does not support\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 推定量とエンジンの組み合わせを確認（使えなければ stderr に出して false）
+ * 
+ * 低食い違い列は2次元の点を x, y の順に返すので、1サンプル = 乱数1個の条件付き推定量では
+ * x 座標と y 座標が混ざった1次元列になり、列の性質が失われる
+ */
+inline bool check_estimator_engine(Estimator estimator, const EngineEntry &engine) {
+    if (estimator == Estimator::Conditional && engine.point_pairs) {
+        std::cerr << "--estimator=conditional draws one coordinate per sample, which " << engine.name
+                  << " does not support\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * カーネルの設定を作る（bitmap カーネルなら表をここで確保・構築し、bitmap が所有する）
+ * 
+ * 表の構築は前処理なので、呼び出し側は実行時間の測定を始める前に呼ぶ
+ */
+inline KernelConfig make_kernel_config(Kernel kernel, const BenchOptions &options,
+                                       std::unique_ptr<CellBitmap> &bitmap) {
+    KernelConfig config;
+    config.kernel = kernel;
+    if (kernel == Kernel::Bitmap) {
+        bitmap = std::make_unique<CellBitmap>(options.bitmap_bits, options.huge_pages);
+        config.bitmap = bitmap.get();
+    }
+    return config;
+}
+
+/**
+ * 推定量の設定を仕上げ、実際に使う試行回数を返す（層別なら配置、制御変量なら多角形をここで作る）
+ * 
+ * 層別は境界セル1つあたり m 点しか打たないので、試行回数は --iterations ではなく
+ * 境界セルの数 × m になる。配置は全行を数える O(S) の前処理なので、
+ * 呼び出し側は実行時間の測定を始める前に呼ぶ
+ */
+inline uint64_t prepare_estimator(KernelConfig &config, const BenchOptions &options) {
+    if (config.estimator == Estimator::ControlVariate) config.control = make_control_polygon(options.control_sides);
+    if (config.estimator != Estimator::Stratified) return options.iterations;
+    config.strata = make_strata_layout(options.strata, options.samples_per_cell, options.iterations);
+    return config.strata.samples();
+}
+
+/**
+ * --precision と組み合わせられない設定を拒否（エラーメッセージを stderr に出して false）
+ * 
+ * 層別は試行回数が配置で決まり、チャンクの平均が揃わないので途中で止められない。
+ * 複製（--scrambles）は複製間のばらつきで誤差を見るので、1本の区間での停止とは併用しない。
+ * 低食い違い列は複製なしでは誤差を見積もれない（interval_basis）ので使えない
+ */
+inline bool check_precision_options(const KernelConfig &config, const EngineEntry &engine,
+                                    const BenchOptions &options) {
+    if (options.precision <= 0.0) return true;
+    if (engine.point_pairs) {
+        std::cerr << "--precision is not available with --engine=" << engine.name
+                  << " (no error estimate without --scrambles)\n";
+        return false;
+    }
+    if (config.estimator == Estimator::Stratified) {
+        std::cerr << "--precision is not available with --estimator=stratified\n";
+        return false;
+    }
+    if (options.scrambles > 1) {
+        std::cerr << "--precision is only available with --scrambles=1\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * カーネル固有の設定を JSON のフィールドとして出力（該当なしなら何も出さない）
+ */
+inline void print_kernel_config_json(const KernelConfig &config) {
+    if (config.kernel == Kernel::Float) {
+        std::cout << "  \"float_lanes\": " << FLOAT_LANES << ",\n";
+    }
+    if (config.bitmap) {
+        std::cout << "  \"bitmap_bits\": " << config.bitmap->bits() << ",\n";
+        std::cout << "  \"bitmap_bytes\": " << config.bitmap->bytes() << ",\n";
+        std::cout << "  \"huge_pages\": " << (config.bitmap->huge_pages() ? "true" : "false") << ",\n";
+    }
+}
+
+/**
+ * 分散・標準誤差の比（分母が0なら0、サンプルが少なく分散が0のときに inf / nan を JSON に出さない）
+ */
+inline double ratio_or_zero(double numerator, double denominator) {
+    return (denominator > 0.0) ? numerator / denominator : 0.0;
+}
+
+/**
+ * 推定量の統計を JSON のフィールドとして出力
+ * 
+ * baseline（同じ試行回数の当たり外れ）があれば、サンプルあたりの分散の比と、
+ * 標準誤差が target_error に達するまでの時間（必要なサンプル数 = 分散 / E^2 に
+ * 1サンプルあたりの実測時間を掛けたもの）と、1秒で達する標準誤差 sqrt(分散 × 1サンプルの秒数)
+ * （error_per_cpu_second、シングルスレッド版は CPU 時間、並列版は壁時計の時間）を並べる。
+ * 統計量は15桁、時間は2桁で出す（呼び出し後は15桁に戻る）。
+ * 
+ * @param config 推定量・カーネルの種類
+ * @param moments 推定量のサンプル値の和と二乗和
+ * @param elapsed_ms 推定量の実行時間
+ * @param baseline 当たり外れの和と二乗和（比較しなければ nullptr）
+ * @param baseline_ms 当たり外れの実行時間
+ * @param target_error 目標の標準誤差
+ */
+inline void print_estimator_json(const KernelConfig &config, const Moments &moments, double elapsed_ms,
+                                 const Moments *baseline, double baseline_ms, double target_error) {
+    double variance = moments.variance();
+    std::cout << std::setprecision(15);
+    std::cout << "  \"estimator\": \"" << estimator_name(config.estimator) << "\",\n";
+    std::cout << "  \"randoms_per_sample\": " << randoms_per_sample(config) << ",\n";
+    std::cout << "  \"variance_per_sample\": " << variance << ",\n";
+    if (config.estimator == Estimator::Antithetic) {
+        // 1サンプル = 点の組なので、判定した点の数は2倍
+        std::cout << "  \"points_evaluated\": " << 2 * moments.n << ",\n";
+        std::cout << "  \"effective_samples\": " << std::llround(antithetic_effective_samples(moments)) << ",\n";
+        std::cout << "  \"antithetic_correlation\": " << antithetic_correlation(moments) << ",\n";
+    }
+    if (config.estimator == Estimator::Stratified) {
+        std::cout << "  \"strata\": " << config.strata.strata << ",\n";
+        std::cout << "  \"samples_per_cell\": " << config.strata.samples_per_cell << ",\n";
+        std::cout << "  \"inside_cells\": " << config.strata.inside_cells << ",\n";
+        std::cout << "  \"boundary_cells\": " << config.strata.boundary_cells << ",\n";
+    }
+    if (config.estimator == Estimator::ControlVariate) {
+        // 同じ点の当たり外れ（補正前の f）との分散の比が制御変量による分散の削減率
+        double raw_variance = moments.raw_variance();
+        std::cout << "  \"control_sides\": " << config.control.sides << ",\n";
+        std::cout << "  \"control_mean\": " << moments.control_mean << ",\n";
+        std::cout << "  \"control_coefficient\": " << moments.control_coefficient() << ",\n";
+        std::cout << "  \"control_correlation\": "
+                  << ratio_or_zero(moments.control_covariance(), std::sqrt(raw_variance * moments.control_variance()))
+                  << ",\n";
+        std::cout << "  \"plain_variance_per_sample\": " << raw_variance << ",\n";
+        std::cout << "  \"variance_reduction\": " << ratio_or_zero(raw_variance, variance) << ",\n";
+    }
+    if (baseline) {
+        double baseline_variance = baseline->variance();
+        double samples_to_target = variance / (target_error * target_error);
+        double baseline_samples_to_target = baseline_variance / (target_error * target_error);
+        std::cout << "  \"baseline_variant\": \"" << kernel_variant(config.kernel) << "\",\n";
+        std::cout << "  \"baseline_variance_per_sample\": " << baseline_variance << ",\n";
+        std::cout << "  \"variance_ratio\": " << ratio_or_zero(baseline_variance, variance) << ",\n";
+        std::cout << "  \"target_error\": " << target_error << ",\n";
+        std::cout << std::setprecision(2);
+        std::cout << "  \"baseline_time_ms\": " << baseline_ms << ",\n";
+        std::cout << "  \"time_to_target_ms\": "
+                  << samples_to_target * elapsed_ms / (double)moments.n << ",\n";
+        std::cout << "  \"baseline_time_to_target_ms\": "
+                  << baseline_samples_to_target * baseline_ms / (double)baseline->n << ",\n";
+        std::cout << std::setprecision(15);
+        std::cout << "  \"error_per_cpu_second\": "
+                  << std::sqrt(variance * elapsed_ms / 1000.0 / (double)moments.n) << ",\n";
+        std::cout << "  \"baseline_error_per_cpu_second\": "
+                  << std::sqrt(baseline_variance * baseline_ms / 1000.0 / (double)baseline->n) << ",\n";
+    }
+}
+
+/**
+ * 目標精度モード（--precision）の結果をJSONで出力
+ * 
+ * @param options 目標の半幅・信頼水準・試行回数の上限
+ * @param stats 停止時の全スレッドのチャンク単位の統計
+ * @param converged 半幅が目標以下になって止まったか（false なら上限で打ち切り）
+ */
+inline void print_precision_json(const BenchOptions &options, const StreamingStats &stats, bool converged) {
+    std::cout << "  \"target_precision\": " << options.precision << ",\n";
+    std::cout << "  \"confidence\": " << options.confidence << ",\n";
+    std::cout << "  \"half_width\": " << confidence_z(options.confidence) * stats.std_error() << ",\n";
+    std::cout << "  \"converged\": " << (converged ? "true" : "false") << ",\n";
+    std::cout << "  \"samples_used\": " << stats.n << ",\n";
+    std::cout << "  \"max_iterations\": " << options.max_iterations << ",\n";
+}
+
+/**
+ * 複製（--scrambles）の推定値の平均
+ */
+inline double replica_mean(const std::vector<double> &estimates) {
+    double sum = 0.0;
+    for (double estimate : estimates) sum += estimate;
+    return sum / (double)estimates.size();
+}
+
+/**
+ * 複製の推定値のばらつきから求めた平均の標準誤差（複製が1本なら0）
+ */
+inline double replica_std_error(const std::vector<double> &estimates) {
+    size_t r = estimates.size();
+    if (r < 2) return 0.0;
+    double mean = replica_mean(estimates);
+    double sum_sq = 0.0;
+    for (double estimate : estimates) sum_sq += (estimate - mean) * (estimate - mean);
+    return std::sqrt(sum_sq / (double)(r - 1) / (double)r);
+}
+
+/**
+ * 複製の統計を JSON のフィールドとして出力（複製が1本なら何も出さない）
+ * 
+ * std_error はサンプルが独立だとみなした値なので、低食い違い列では実際の誤差より大きい。
+ * 複製間のばらつきによる標準誤差 scramble_std_error との分散の比が、
+ * 同じサンプル数で乱数列に対して得をしている倍率になる。
+ * 
+ * @param estimates 複製ごとの推定値
+ * @param moments 全複製のサンプル値の和と二乗和
+ */
+inline void print_replica_json(const std::vector<double> &estimates, const Moments &moments) {
+    if (estimates.size() < 2) return;
+    double scramble_error = replica_std_error(estimates);
+    double iid_error = std::sqrt(moments.variance() / (double)moments.n);
+    std::cout << "  \"scrambles\": " << estimates.size() << ",\n";
+    std::cout << "  \"scramble_std_error\": " << scramble_error << ",\n";
+    std::cout << "  \"scramble_variance_ratio\": "
+              << ratio_or_zero(iid_error * iid_error, scramble_error * scramble_error) << ",\n";
+}
+
+/**
+ * 信頼区間の根拠（print_interval_json）
+ */
+enum class IntervalBasis {
+    Iid,        // サンプルを独立とみなした std_error
+    Scrambles,  // 複製間のばらつき（scramble_std_error）
+    None,       // 誤差の見積もりなし（低食い違い列を複製なしで使ったとき）
+};
+
+/**
+ * 信頼区間の根拠を選ぶ
+ * 
+ * 複製が2本以上なら複製の推定値が独立なので、それを使う（低食い違い列でも有効）。
+ * 低食い違い列の1本だけでは、独立サンプルとみなした誤差は実際の誤差の何十倍にもなり、
+ * チャンク平均も互いに相関するので、区間を出さない。
+ */
+inline IntervalBasis interval_basis(const EngineEntry &engine, size_t replicas) {
+    if (replicas >= 2) return IntervalBasis::Scrambles;
+    return engine.point_pairs ? IntervalBasis::None : IntervalBasis::Iid;
+}
+
+/**
+ * チャンク単位の統計・複製から標準誤差と信頼区間をJSONで出力（理論値を使わずに収束を判定する目安）
+ * 
+ * std_error はサンプルの分散から、batch_std_error はチャンク平均のばらつき（batch means）から求める。
+ * 信頼区間（interval_basis で根拠を選ぶ）は、iid なら推定値 ± z × std_error（正規近似）、
+ * scrambles なら複製の平均 ± t(R - 1) × scramble_std_error、none なら出さない。
+ * 
+ * @param pi_estimate 円周率の推定値（区間の中心）
+ * @param stats 全スレッド・全複製のチャンク単位の統計
+ * @param estimates 複製ごとの推定値
+ * @param engine 乱数エンジン（低食い違い列か）
+ */
+inline void print_interval_json(double pi_estimate, const StreamingStats &stats, const std::vector<double> &estimates,
+                                const EngineEntry &engine) {
+    std::cout << "  \"std_error\": " << stats.std_error() << ",\n";
+    std::cout << "  \"batches\": " << stats.batches << ",\n";
+    std::cout << "  \"batch_std_error\": " << stats.batch_std_error() << ",\n";
+    IntervalBasis basis = interval_basis(engine, estimates.size());
+    double half_95 = 0.0, half_99 = 0.0;
+    if (basis == IntervalBasis::Scrambles) {
+        double scramble_error = replica_std_error(estimates);
+        half_95 = student_t_quantile(95, estimates.size() - 1) * scramble_error;
+        half_99 = student_t_quantile(99, estimates.size() - 1) * scramble_error;
+        std::cout << "  \"interval_basis\": \"scrambles\",\n";
+    } else if (basis == IntervalBasis::Iid) {
+        half_95 = Z_95 * stats.std_error();
+        half_99 = Z_99 * stats.std_error();
+        std::cout << "  \"interval_basis\": \"iid\",\n";
+    } else {
+        std::cout << "  \"interval_basis\": \"none\",\n";
+        return;
+    }
+    std::cout << "  \"ci95_low\": " << pi_estimate - half_95 << ",\n";
+    std::cout << "  \"ci95_high\": " << pi_estimate + half_95 << ",\n";
+    std::cout << "  \"ci99_low\": " << pi_estimate - half_99 << ",\n";
+    std::cout << "  \"ci99_high\": " << pi_estimate + half_99 << ",\n";
+}
+
+#endif /* BENCH_OPTIONS_HPP */
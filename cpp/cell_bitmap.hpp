@@ -0,0 +1,145 @@
+#ifndef CELL_BITMAP_HPP
+#define CELL_BITMAP_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/**
+ * 四分円のセル分類ビットマップ（メモリ階層を使うカーネル用の表）
+ *
+ * [0, 1)^2 を 2^BITS × 2^BITS のセルに分け、各セルを2ビットで分類する
+ * （早期判定カーネルの PrefixTable と同じ基準、pi_kernels.hpp を参照）:
+ * - INSIDE   遠い角が円内 ((i+1)^2 + (j+1)^2 < M^2)、セル内の点はすべて円内
+ * - OUTSIDE  近い角が円外 (i^2 + j^2 > M^2)、セル内の点はすべて円外
+ * - BOUNDARY それ以外（円周が通る）、点ごとに倍精度で判定する
+ *
+ * 表の大きさは 2^(2*BITS) / 4 バイトで、解像度でメモリ階層のどこに載るかを選べる:
+ *   BITS =  8 :  16KB（L1）
+ *   BITS = 10 : 256KB（L2）
+ *   BITS = 12 :   4MB（L3）
+ *   BITS = 14 :  64MB（DRAM）
+ *   BITS = 15 : 256MB（DRAM）
+ * 乱数の上位ビットで引くので、アクセスは表全体に一様にランダムに散らばる。
+ *
+ * Linux では huge_pages を指定すると 2MB 境界に揃えた匿名 mmap に
+ * madvise(MADV_HUGEPAGE) を掛け、TLBミスを減らす（Transparent Huge Pages）。
+ */
+class CellBitmap {
+public:
+    static constexpr int MIN_BITS = 4;
+    static constexpr int MAX_BITS = 15;
+    static constexpr uint64_t OUTSIDE = 0;
+    static constexpr uint64_t INSIDE = 1;
+    static constexpr uint64_t BOUNDARY = 2;
+
+    /**
+     * 表を確保して分類を書き込む
+     *
+     * @param bits 1軸あたりの解像度（MIN_BITS 〜 MAX_BITS）
+     * @param huge_pages Transparent Huge Pages を要求するか（Linux のみ有効）
+     */
+    CellBitmap(int bits, bool huge_pages)
+        : bits_(bits), bytes_((size_t)1 << (2 * bits - 2)), words_(nullptr),
+          mapping_(nullptr), mapping_bytes_(0), huge_pages_(false) {
+        allocate(huge_pages);
+        build();
+    }
+
+    ~CellBitmap() {
+#if defined(__linux__)
+        if (mapping_) {
+            munmap(mapping_, mapping_bytes_);
+            return;
+        }
+#endif
+        delete[] words_;
+    }
+
+    CellBitmap(const CellBitmap &) = delete;
+    CellBitmap &operator=(const CellBitmap &) = delete;
+
+    int bits() const { return bits_; }
+    size_t bytes() const { return bytes_; }
+
+    /**
+     * @return madvise(MADV_HUGEPAGE) が成功したか
+     */
+    bool huge_pages() const { return huge_pages_; }
+
+    /**
+     * セル (i, j) の分類（OUTSIDE / INSIDE / BOUNDARY）
+     */
+    inline uint64_t cell(uint64_t i, uint64_t j) const {
+        uint64_t index = (i << bits_) | j;
+        return (words_[index >> 5] >> ((index & 31) * 2)) & 3;
+    }
+
+private:
+    static constexpr size_t HUGE_PAGE_BYTES = (size_t)2 << 20;
+
+    int bits_;
+    size_t bytes_;
+    uint64_t *words_;       // 1語 = 32セル（行優先、セル番号 i * M + j）
+    void *mapping_;         // mmap した領域（huge pages 用、なければ nullptr）
+    size_t mapping_bytes_;
+    bool huge_pages_;
+
+    void allocate(bool huge_pages) {
+#if defined(__linux__)
+        if (huge_pages) {
+            // 2MB 境界に揃えるため1ページ分多く確保する（匿名 mmap はゼロ初期化済み）
+            mapping_bytes_ = bytes_ + HUGE_PAGE_BYTES;
+            void *p = mmap(nullptr, mapping_bytes_, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED) {
+                mapping_ = p;
+                uintptr_t aligned = ((uintptr_t)p + HUGE_PAGE_BYTES - 1) & ~(uintptr_t)(HUGE_PAGE_BYTES - 1);
+                words_ = reinterpret_cast<uint64_t *>(aligned);
+                huge_pages_ = madvise(words_, bytes_, MADV_HUGEPAGE) == 0;
+                return;
+            }
+            mapping_bytes_ = 0;
+        }
+#else
+        (void)huge_pages;
+#endif
+        words_ = new uint64_t[(bytes_ + 7) / 8]();
+    }
+
+    /**
+     * セル番号 [from, to) を code で埋める（表はゼロ = OUTSIDE で初期化済み）
+     */
+    void fill_cells(uint64_t from, uint64_t to, uint64_t code) {
+        const uint64_t pattern = code * 0x5555555555555555ULL;  // 2ビットの code を32個並べた語
+        while (from < to && (from & 31) != 0) {
+            words_[from >> 5] |= code << ((from & 31) * 2);
+            from++;
+        }
+        for (; from + 32 <= to; from += 32) {
+            words_[from >> 5] = pattern;
+        }
+        for (; from < to; from++) {
+            words_[from >> 5] |= code << ((from & 31) * 2);
+        }
+    }
+
+    /**
+     * 行 i ごとに円内・境界の範囲を求めて書き込む（閾値は i とともに単調に減る）
+     */
+    void build() {
+        const uint64_t m = 1ULL << bits_;
+        uint64_t in = m, out = m;
+        for (uint64_t i = 0; i < m; i++) {
+            while (in > 0 && (i + 1) * (i + 1) + in * in >= m * m) in--;
+            while (out > 0 && i * i + (out - 1) * (out - 1) > m * m) out--;
+            fill_cells(i * m, i * m + in, INSIDE);
+            fill_cells(i * m + in, i * m + out, BOUNDARY);
+        }
+    }
+};
+
+#endif /* CELL_BITMAP_HPP */
@@ -0,0 +1,276 @@
+#ifndef CHACHA_HPP
+#define CHACHA_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include "xoshiro256.hpp"
+#include "engines.hpp"
+
+/**
+ * ChaCha8 / ChaCha12 乱数エンジン（ストリーム暗号の鍵ストリームを乱数として使う）
+ *
+ * アルゴリズムの背景:
+ * - 乱数の品質を問われたときの比較用。暗号として設計されたブロック関数なので、
+ *   統計的な偏りを指摘される余地がない（rand_chacha や C++ の提案でも使われる）
+ * - 1ブロック = 32ビット語16個 = 64ビット乱数8個。ブロックはカウンタの関数なので、
+ *   discard() はカウンタの加算だけで済む（カウンタ型エンジン、counter_engines.hpp と同じ）
+ * - 状態は D. J. Bernstein のオリジナル版と同じ配置
+ *   （定数4語、鍵8語、64ビットブロックカウンタ、64ビットノンス）
+ *
+ * SIMD化:
+ * - 複数ブロックを「縦に」並べる。ベクトル k のレーン b がブロック b の語 k になるので、
+ *   クォーターラウンドはレーン間のシャッフルなしで加算・XOR・ローテートだけになる
+ * - AVX2 は8ブロック、SSE2 は4ブロックを同時に計算する（ChaChaAvx2Ops / ChaChaSse2Ops）。
+ *   16, 8 ビットのローテートは AVX2 ではバイトシャッフル1命令で済む
+ * - 出力はスカラー版と同じ順序（ブロック順、ブロック内は語の順）に並べ替えて返す
+ */
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * スカラー版のレーン演算（1ブロック、コンパイル時の既知解チェックにも使う）
+ */
+struct ChaChaScalarOps {
+    using V = uint32_t;
+    static constexpr int LANES = 1;
+
+    static constexpr V load(const uint32_t *p) { return p[0]; }
+    static constexpr void store(uint32_t *p, V x) { p[0] = x; }
+    static constexpr V add(V a, V b) { return a + b; }
+    static constexpr V xor_(V a, V b) { return a ^ b; }
+    template <int K>
+    static constexpr V rotl(V x) { return (x << K) | (x >> (32 - K)); }
+};
+
+#if defined(__SSE2__)
+
+/**
+ * SSE2版のレーン演算（4ブロック、XMMレジスタ）
+ */
+struct ChaChaSse2Ops {
+    using V = __m128i;
+    static constexpr int LANES = 4;
+
+    static inline V load(const uint32_t *p) { return _mm_load_si128(reinterpret_cast<const __m128i *>(p)); }
+    static inline void store(uint32_t *p, V x) { _mm_store_si128(reinterpret_cast<__m128i *>(p), x); }
+    static inline V add(V a, V b) { return _mm_add_epi32(a, b); }
+    static inline V xor_(V a, V b) { return _mm_xor_si128(a, b); }
+    template <int K>
+    static inline V rotl(V x) { return _mm_or_si128(_mm_slli_epi32(x, K), _mm_srli_epi32(x, 32 - K)); }
+};
+
+#endif /* __SSE2__ */
+
+#if defined(__AVX2__)
+
+/**
+ * AVX2版のレーン演算（8ブロック、YMMレジスタ）
+ */
+struct ChaChaAvx2Ops {
+    using V = __m256i;
+    static constexpr int LANES = 8;
+
+    static inline V load(const uint32_t *p) { return _mm256_load_si256(reinterpret_cast<const __m256i *>(p)); }
+    static inline void store(uint32_t *p, V x) { _mm256_store_si256(reinterpret_cast<__m256i *>(p), x); }
+    static inline V add(V a, V b) { return _mm256_add_epi32(a, b); }
+    static inline V xor_(V a, V b) { return _mm256_xor_si256(a, b); }
+    template <int K>
+    static inline V rotl(V x) {
+        if constexpr (K == 16) {
+            const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                                   2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+            return _mm256_shuffle_epi8(x, rot16);
+        } else if constexpr (K == 8) {
+            const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                                  3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+            return _mm256_shuffle_epi8(x, rot8);
+        } else {
+            return _mm256_or_si256(_mm256_slli_epi32(x, K), _mm256_srli_epi32(x, 32 - K));
+        }
+    }
+};
+
+#endif /* __AVX2__ */
+
+/**
+ * クォーターラウンド（a, b, c, d は状態の語番号）
+ */
+template <class Ops>
+constexpr void chacha_quarter_round(typename Ops::V *x, int a, int b, int c, int d) {
+    x[a] = Ops::add(x[a], x[b]); x[d] = Ops::template rotl<16>(Ops::xor_(x[d], x[a]));
+    x[c] = Ops::add(x[c], x[d]); x[b] = Ops::template rotl<12>(Ops::xor_(x[b], x[c]));
+    x[a] = Ops::add(x[a], x[b]); x[d] = Ops::template rotl<8>(Ops::xor_(x[d], x[a]));
+    x[c] = Ops::add(x[c], x[d]); x[b] = Ops::template rotl<7>(Ops::xor_(x[b], x[c]));
+}
+
+/**
+ * 連続する Ops::LANES 個のブロックを計算
+ *
+ * @param key 鍵（32ビット語8個）
+ * @param first_block 先頭ブロックのカウンタ
+ * @param nonce ノンス（ストリーム番号）
+ * @param out 出力 out[k * LANES + b] = ブロック first_block + b の語 k
+ */
+template <class Ops, int ROUNDS>
+constexpr void chacha_blocks(const uint32_t key[8], uint64_t first_block, uint64_t nonce, uint32_t *out) {
+    constexpr int L = Ops::LANES;
+    alignas(64) uint32_t input[16 * L] = {};
+    for (int b = 0; b < L; b++) {
+        const uint32_t words[16] = {
+            0x61707865, 0x3320646E, 0x79622D32, 0x6B206574,  // "expand 32-byte k"
+            key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+            (uint32_t)(first_block + b), (uint32_t)((first_block + b) >> 32),
+            (uint32_t)nonce, (uint32_t)(nonce >> 32)};
+        for (int k = 0; k < 16; k++) input[k * L + b] = words[k];
+    }
+
+    typename Ops::V x[16] = {};
+    for (int k = 0; k < 16; k++) x[k] = Ops::load(&input[k * L]);
+
+    for (int i = 0; i < ROUNDS; i += 2) {
+        // 列ラウンド
+        chacha_quarter_round<Ops>(x, 0, 4, 8, 12);
+        chacha_quarter_round<Ops>(x, 1, 5, 9, 13);
+        chacha_quarter_round<Ops>(x, 2, 6, 10, 14);
+        chacha_quarter_round<Ops>(x, 3, 7, 11, 15);
+        // 対角ラウンド
+        chacha_quarter_round<Ops>(x, 0, 5, 10, 15);
+        chacha_quarter_round<Ops>(x, 1, 6, 11, 12);
+        chacha_quarter_round<Ops>(x, 2, 7, 8, 13);
+        chacha_quarter_round<Ops>(x, 3, 4, 9, 14);
+    }
+
+    for (int k = 0; k < 16; k++) {
+        Ops::store(&out[k * L], Ops::add(x[k], Ops::load(&input[k * L])));
+    }
+}
+
+/**
+ * ChaCha エンジン（ROUNDS = 8 または 12）
+ *
+ * 出力 i はブロック i / 8 の64ビット語 i % 8（32ビット語 2j, 2j+1 をリトルエンディアンで連結）。
+ * 鍵はシードを SplitMix64 で256ビットに展開したもの、ノンスは0。
+ */
+template <int ROUNDS>
+class ChaCha : public EngineBase<ChaCha<ROUNDS>> {
+public:
+    static constexpr int OUTPUTS_PER_BLOCK = 8;
+    static constexpr int BATCH_BLOCKS = 8;  // 1回の生成で計算するブロック数（AVX2の1回分）
+    static constexpr int BATCH_OUTPUTS = BATCH_BLOCKS * OUTPUTS_PER_BLOCK;
+
+#if defined(__AVX2__)
+    using BatchOps = ChaChaAvx2Ops;
+#elif defined(__SSE2__)
+    using BatchOps = ChaChaSse2Ops;
+#else
+    using BatchOps = ChaChaScalarOps;
+#endif
+
+    /**
+     * ブロック first_block から BATCH_BLOCKS 個分の64ビット乱数を生成
+     *
+     * @param out 出力先（BATCH_OUTPUTS 要素、スカラー版と同じ順序）
+     */
+    static inline void generate_batch(const uint32_t key[8], uint64_t first_block, uint64_t nonce,
+                                      uint64_t *out) {
+        constexpr int L = BatchOps::LANES;
+        alignas(64) uint32_t words[16 * L];
+        for (int g = 0; g < BATCH_BLOCKS; g += L) {
+            chacha_blocks<BatchOps, ROUNDS>(key, first_block + g, nonce, words);
+            for (int b = 0; b < L; b++) {
+                for (int j = 0; j < OUTPUTS_PER_BLOCK; j++) {
+                    out[(g + b) * OUTPUTS_PER_BLOCK + j] =
+                        words[(2 * j) * L + b] | ((uint64_t)words[(2 * j + 1) * L + b] << 32);
+                }
+            }
+        }
+    }
+
+private:
+    uint32_t key[8];
+    uint64_t nonce;
+    uint64_t index;                   // 次に返す出力の番号
+    uint64_t buffer[BATCH_OUTPUTS];   // バッチ index / BATCH_OUTPUTS の出力
+
+    inline void refill() { generate_batch(key, index / BATCH_OUTPUTS * BATCH_BLOCKS, nonce, buffer); }
+
+public:
+    explicit ChaCha(uint64_t seed) : key{}, nonce(0), index(0), buffer{} {
+        SplitMix64 sm(seed);
+        for (int i = 0; i < 4; i++) {
+            uint64_t k = sm.next();
+            key[2 * i] = (uint32_t)k;
+            key[2 * i + 1] = (uint32_t)(k >> 32);
+        }
+    }
+
+    inline uint64_t next() {
+        if (index % BATCH_OUTPUTS == 0) refill();
+        return buffer[index++ % BATCH_OUTPUTS];
+    }
+
+    /**
+     * n 個まとめて生成（バッチ境界の間はバッファを経由せず直接変換する）
+     */
+    inline void fill_double(double *out, size_t n) {
+        size_t i = 0;
+        for (; i < n && index % BATCH_OUTPUTS != 0; i++) {
+            out[i] = u64_to_double(next());
+        }
+        uint64_t raw[BATCH_OUTPUTS];
+        for (; i + BATCH_OUTPUTS <= n; i += BATCH_OUTPUTS) {
+            generate_batch(key, index / BATCH_OUTPUTS * BATCH_BLOCKS, nonce, raw);
+            for (int j = 0; j < BATCH_OUTPUTS; j++) out[i + j] = u64_to_double(raw[j]);
+            index += BATCH_OUTPUTS;
+        }
+        for (; i < n; i++) {
+            out[i] = u64_to_double(next());
+        }
+    }
+
+    /**
+     * n 個まとめて生成（バッチ境界の間は呼び出し側のバッファへ直接書く）
+     */
+    inline void fill(uint64_t *out, size_t n) {
+        size_t i = 0;
+        for (; i < n && index % BATCH_OUTPUTS != 0; i++) {
+            out[i] = next();
+        }
+        for (; i + BATCH_OUTPUTS <= n; i += BATCH_OUTPUTS) {
+            generate_batch(key, index / BATCH_OUTPUTS * BATCH_BLOCKS, nonce, out + i);
+            index += BATCH_OUTPUTS;
+        }
+        for (; i < n; i++) {
+            out[i] = next();
+        }
+    }
+
+    inline void discard(uint64_t n) {
+        index += n;
+        if (index % BATCH_OUTPUTS != 0) refill();
+    }
+};
+
+using ChaCha8 = ChaCha<8>;
+using ChaCha12 = ChaCha<12>;
+
+namespace engines_detail {
+
+// 鍵・カウンタ・ノンスがすべて0のときの鍵ストリーム先頭（ChaCha の公開テストベクトル）
+template <int ROUNDS>
+constexpr bool chacha_zero_kat(uint32_t w0, uint32_t w1, uint32_t w15) {
+    const uint32_t zero_key[8] = {};
+    uint32_t out[16] = {};
+    chacha_blocks<ChaChaScalarOps, ROUNDS>(zero_key, 0, 0, out);
+    return out[0] == w0 && out[1] == w1 && out[15] == w15;
+}
+
+static_assert(chacha_zero_kat<8>(0x2FEF003E, 0xD6405F89, 0x42FE0C0E), "ChaCha8 KAT");
+static_assert(chacha_zero_kat<12>(0x6A9AF49B, 0x53F95507, 0xBE261341), "ChaCha12 KAT");
+static_assert(chacha_zero_kat<20>(0xADE0B876, 0x903DF1A0, 0x8665EEB2), "ChaCha20 KAT");
+
+}  // namespace engines_detail
+
+#endif /* CHACHA_HPP */
@@ -0,0 +1,193 @@
+#ifndef COUNTER_ENGINES_HPP
+#define COUNTER_ENGINES_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include "xoshiro256.hpp"
+#include "engines.hpp"
+
+/**
+ * カウンタ型（状態を持たない）乱数エンジン
+ *
+ * アルゴリズムの背景:
+ * - Xoshiro系は i 番目の出力を得るのに直前の状態が必要で、チャンクの開始位置へは
+ *   discard()（O(log n) の多項式演算）で進めるしかない
+ * - カウンタ型は i 番目の出力を (key, i) の純粋関数 f(key, i) として定義する。
+ *   どのスレッド・SIMDレーンも任意の区間を直接計算でき、discard() は加算だけ
+ * - 各要素が独立に計算できるので、fill_double() のループは依存チェーンがなく
+ *   コンパイラがそのままベクトル化・パイプライン化できる
+ *
+ * エンジンの要件（engines.hpp）をそのまま満たすので、カーネル・レジストリは共通。
+ * スレッド数やチャンク長を変えても、並列版の結果はシングルスレッド版と一致する。
+ */
+
+/**
+ * Philox4x64-10（Random123、Salmon et al. 2011）
+ *
+ * 256ビットのカウンタを128ビットの鍵で10ラウンド暗号化し、1ブロックで64ビット乱数を4個得る。
+ * 1ラウンドは 64×64→128ビット乗算2回と XOR のみ。
+ * 出力 i はブロック i / 4（カウンタ {i / 4, 0, 0, 0}、鍵 {seed, 0}）の i % 4 番目の語。
+ */
+class Philox4x64 : public EngineBase<Philox4x64> {
+public:
+    struct Block {
+        uint64_t v[4];
+    };
+
+    /**
+     * カウンタ1ブロックを暗号化（Random123 の philox4x64_R(10, ctr, key) と同じ）
+     *
+     * @param ctr カウンタ
+     * @param k0 鍵の下位64ビット
+     * @param k1 鍵の上位64ビット
+     * @return 64ビット乱数4個
+     */
+    static constexpr Block generate(Block ctr, uint64_t k0, uint64_t k1) {
+        for (int round = 0; round < ROUNDS; round++) {
+            if (round > 0) {
+                k0 += BUMP0;
+                k1 += BUMP1;
+            }
+            unsigned __int128 p0 = (unsigned __int128)MULT0 * ctr.v[0];
+            unsigned __int128 p1 = (unsigned __int128)MULT1 * ctr.v[2];
+            ctr = {{(uint64_t)(p1 >> 64) ^ ctr.v[1] ^ k0, (uint64_t)p1,
+                    (uint64_t)(p0 >> 64) ^ ctr.v[3] ^ k1, (uint64_t)p0}};
+        }
+        return ctr;
+    }
+
+    /**
+     * 鍵 key の系列の index 番目の出力（状態なしで直接計算）
+     */
+    static constexpr uint64_t at(uint64_t key, uint64_t index) {
+        return generate({{index / 4, 0, 0, 0}}, key, 0).v[index % 4];
+    }
+
+private:
+    static constexpr int ROUNDS = 10;
+    static constexpr uint64_t MULT0 = 0xD2E7470EE14C6C93ULL;
+    static constexpr uint64_t MULT1 = 0xCA5A826395121157ULL;
+    static constexpr uint64_t BUMP0 = 0x9E3779B97F4A7C15ULL;  // 黄金比
+    static constexpr uint64_t BUMP1 = 0xBB67AE8584CAA73BULL;  // sqrt(3) - 1
+
+    uint64_t key;
+    uint64_t index;  // 次に返す出力の番号
+    Block buffer;    // ブロック index / 4 の出力（index % 4 != 0 のときだけ有効）
+
+    constexpr void refill() { buffer = generate({{index / 4, 0, 0, 0}}, key, 0); }
+
+public:
+    constexpr explicit Philox4x64(uint64_t seed) : key(seed), index(0), buffer{} {}
+
+    constexpr uint64_t next() {
+        if (index % 4 == 0) refill();
+        return buffer.v[index++ % 4];
+    }
+
+    /**
+     * n 個まとめて生成（ブロック境界の間はバッファを経由せず直接書き込む）
+     */
+    inline void fill_double(double *out, size_t n) {
+        size_t i = 0;
+        for (; i < n && index % 4 != 0; i++) {
+            out[i] = u64_to_double(next());
+        }
+        for (; i + 4 <= n; i += 4) {
+            Block b = generate({{index / 4, 0, 0, 0}}, key, 0);
+            for (int j = 0; j < 4; j++) out[i + j] = u64_to_double(b.v[j]);
+            index += 4;
+        }
+        for (; i < n; i++) {
+            out[i] = u64_to_double(next());
+        }
+    }
+
+    constexpr void discard(uint64_t n) {
+        index += n;
+        if (index % 4 != 0) refill();
+    }
+};
+
+/**
+ * ハッシュ型カウンタエンジン（インデックスを murmur3 の fmix64 で混ぜる）
+ *
+ * 出力 i = fmix64((i * 黄金比) ^ key)、key はシードを fmix64 で混ぜたもの。
+ * SplitMix64 と違って鍵を加算ではなく XOR で入れるので、別の鍵の系列が
+ * 同じ系列をずらしただけのものにならない。
+ * 乗算は64ビットの下位だけなので、AVX2/AVX-512 の整数乗算でベクトル化できる。
+ */
+class HashCounter64 : public EngineBase<HashCounter64> {
+private:
+    static constexpr uint64_t GOLDEN = 0x9E3779B97F4A7C15ULL;
+    uint64_t key;
+    uint64_t index;  // 次に返す出力の番号
+
+    static constexpr uint64_t fmix64(uint64_t z) {
+        z = (z ^ (z >> 33)) * 0xFF51AFD7ED558CCDULL;
+        z = (z ^ (z >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+        return z ^ (z >> 33);
+    }
+
+public:
+    /**
+     * 鍵 key の系列の index 番目の出力（状態なしで直接計算）
+     */
+    static constexpr uint64_t at(uint64_t key, uint64_t index) {
+        return fmix64((index * GOLDEN) ^ key);
+    }
+
+    constexpr explicit HashCounter64(uint64_t seed) : key(fmix64(seed + GOLDEN)), index(0) {}
+
+    constexpr uint64_t next() { return at(key, index++); }
+
+    /**
+     * n 個まとめて生成（各要素が独立なのでループがそのままベクトル化される）
+     */
+    inline void fill_double(double *out, size_t n) {
+        const uint64_t k = key;
+        const uint64_t base = index;
+        for (size_t i = 0; i < n; i++) {
+            out[i] = u64_to_double(at(k, base + i));
+        }
+        index += n;
+    }
+
+    constexpr void discard(uint64_t n) { index += n; }
+};
+
+namespace engines_detail {
+
+// Random123 の kat_vectors（philox4x64 10 ラウンド）
+constexpr bool philox_kat(Philox4x64::Block ctr, uint64_t k0, uint64_t k1, Philox4x64::Block expected) {
+    Philox4x64::Block out = Philox4x64::generate(ctr, k0, k1);
+    for (int i = 0; i < 4; i++) {
+        if (out.v[i] != expected.v[i]) return false;
+    }
+    return true;
+}
+
+static_assert(philox_kat({{0, 0, 0, 0}}, 0, 0,
+                         {{0x16554D9ECA36314CULL, 0xDB20FE9D672D0FDCULL,
+                           0xD7E772CEE186176BULL, 0x7E68B68AEC7BA23BULL}}),
+              "Philox4x64-10 KAT (zero)");
+static_assert(philox_kat({{~0ULL, ~0ULL, ~0ULL, ~0ULL}}, ~0ULL, ~0ULL,
+                         {{0x87B092C3013FE90BULL, 0x438C3C67BE8D0224ULL,
+                           0x9CC7D7C69CD777B6ULL, 0xA09CAEBF594F0BA0ULL}}),
+              "Philox4x64-10 KAT (all ones)");
+static_assert(philox_kat({{0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL,
+                           0xA4093822299F31D0ULL, 0x082EFA98EC4E6C89ULL}},
+                         0x452821E638D01377ULL, 0xBE5466CF34E90C6CULL,
+                         {{0xA528F45403E61D95ULL, 0x38C72DBD566E9788ULL,
+                           0xA5A1610E72FD18B5ULL, 0x57BD43B5E52B7FE6ULL}}),
+              "Philox4x64-10 KAT (pi digits)");
+
+// 逐次生成・discard()・直接計算 at() が同じ値になること
+static_assert(nth_output(Philox4x64(7), 1001) == Philox4x64::at(7, 1001), "Philox4x64 at");
+static_assert(nth_output_after_discard(Philox4x64(7), 1001) == nth_output(Philox4x64(7), 1001),
+              "Philox4x64 discard");
+static_assert(nth_output_after_discard(HashCounter64(7), 1001) == nth_output(HashCounter64(7), 1001),
+              "HashCounter64 discard");
+
+}  // namespace engines_detail
+
+#endif /* COUNTER_ENGINES_HPP */
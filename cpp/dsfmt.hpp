@@ -0,0 +1,193 @@
+#ifndef DSFMT_HPP
+#define DSFMT_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "engines.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * dSFMT-19937（倍精度SIMD指向 Mersenne Twister、斎藤・松本 2009）
+ *
+ * アルゴリズムの背景:
+ * - xoshiro256.hpp のコメントでは MT19937 を「状態が大きくキャッシュ効率が悪い、
+ *   SIMD化の妨げになる」としているが、dSFMT はその反例になりうる設計:
+ *   状態は128ビット語 191 個（約3KB、L1に収まる）で、漸化式は128ビットベクトルの
+ *   シフト・シャッフル・XOR だけ。状態の各64ビット語がそのまま [1, 2) の倍精度になる
+ *   （指数部は常に 0x3FF、下位52ビットだけが乱数）
+ * - 1回の gen_rand_all() で 382 個の倍精度をまとめて生成するので、
+ *   fill_double() は状態を読んで 1.0 を引くだけのベクトル化されたコピーになる
+ *
+ * 出力の対応:
+ * - next_double() = (参照実装の genrand_close1_open2()) - 1.0（52ビット精度、正確）
+ * - next() はその52ビットを上位に詰めた64ビット値なので、
+ *   EngineBase の (next() >> 11) * 2^-53 と同じ値になる
+ * - discard() は状態を丸ごと再生成しながら進める O(n)（ジャンプ多項式は次数19937で、
+ *   コンパイル時計算の対象外）。並列版の各スレッドは先頭区間を生成し直すことになる
+ */
+class Dsfmt19937 : public EngineBase<Dsfmt19937> {
+public:
+    static constexpr int N = 191;        // 128ビット語の個数（(19937 - 128) / 104 + 1）
+    static constexpr int N64 = 2 * N;    // 1回の生成で得られる倍精度の個数
+    static constexpr int POS1 = 117;
+    static constexpr int SL1 = 19;
+    static constexpr int SR = 12;
+    static constexpr uint64_t MSK1 = 0x000FFAFFFFFFFB3FULL;
+    static constexpr uint64_t MSK2 = 0x000FFDFFFC90FFFDULL;
+    static constexpr uint64_t FIX1 = 0x90014964B32F4329ULL;
+    static constexpr uint64_t FIX2 = 0x3B8D12AC548A7C7AULL;
+    static constexpr uint64_t PCV1 = 0x3D84E1AC0DC82880ULL;
+    static constexpr uint64_t PCV2 = 0x0000000000000001ULL;
+    static constexpr uint64_t LOW_MASK = 0x000FFFFFFFFFFFFFULL;
+    static constexpr uint64_t HIGH_CONST = 0x3FF0000000000000ULL;  // 1.0 の指数部
+
+    /**
+     * 状態（u[0..N-1] が出力、u[N] は漸化式の内部語 lung）
+     */
+    struct State {
+        alignas(16) uint64_t u[N + 1][2];
+    };
+
+    /**
+     * 参照実装の dsfmt_init_gen_rand() と同じ初期化
+     *
+     * @param seed 32ビットのシード
+     * @return 初期状態（最初の gen_rand_all() の前）
+     */
+    static constexpr State init_state(uint32_t seed) {
+        State st = {};
+        uint32_t prev = seed;
+        for (int i = 0; i < (N + 1) * 4; i++) {
+            uint32_t w = (i == 0) ? seed : 1812433253U * (prev ^ (prev >> 30)) + (uint32_t)i;
+            st.u[i / 4][(i / 2) % 2] |= (uint64_t)w << (32 * (i % 2));
+            prev = w;
+        }
+        // initial_mask: 出力語を [1, 2) の倍精度にする
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < 2; j++) st.u[i][j] = (st.u[i][j] & LOW_MASK) | HIGH_CONST;
+        }
+        // period_certification: 周期 2^19937 - 1 を保証する
+        uint64_t inner = ((st.u[N][0] ^ FIX1) & PCV1) ^ ((st.u[N][1] ^ FIX2) & PCV2);
+        for (int i = 32; i > 0; i >>= 1) inner ^= inner >> i;
+        if ((inner & 1) == 0) st.u[N][1] ^= 1;
+        return st;
+    }
+
+    /**
+     * 状態全体を更新（スカラー版、参照実装の非SIMD版 do_recursion と同じ）
+     */
+    static constexpr void gen_rand_all_scalar(State &st) {
+        uint64_t l0 = st.u[N][0], l1 = st.u[N][1];
+        for (int i = 0; i < N; i++) {
+            const uint64_t *b = st.u[(i + POS1 < N) ? i + POS1 : i + POS1 - N];
+            uint64_t t0 = st.u[i][0], t1 = st.u[i][1];
+            uint64_t n0 = (t0 << SL1) ^ (l1 >> 32) ^ (l1 << 32) ^ b[0];
+            uint64_t n1 = (t1 << SL1) ^ (l0 >> 32) ^ (l0 << 32) ^ b[1];
+            st.u[i][0] = (n0 >> SR) ^ (n0 & MSK1) ^ t0;
+            st.u[i][1] = (n1 >> SR) ^ (n1 & MSK2) ^ t1;
+            l0 = n0;
+            l1 = n1;
+        }
+        st.u[N][0] = l0;
+        st.u[N][1] = l1;
+    }
+
+    /**
+     * 状態全体を更新（SSE2があれば128ビットベクトル版）
+     *
+     * lung の 32ビット語の入れ替え（(L >> 32) ^ (L << 32) を語をまたいで取る）は
+     * _mm_shuffle_epi32 の1命令になる
+     */
+    static inline void gen_rand_all(State &st) {
+#if defined(__SSE2__)
+        const __m128i mask = _mm_set_epi64x((long long)MSK2, (long long)MSK1);
+        __m128i *s = reinterpret_cast<__m128i *>(st.u);
+        __m128i lung = _mm_load_si128(&s[N]);
+        for (int i = 0; i < N; i++) {
+            __m128i x = _mm_load_si128(&s[i]);
+            __m128i b = _mm_load_si128(&s[(i + POS1 < N) ? i + POS1 : i + POS1 - N]);
+            __m128i z = _mm_xor_si128(_mm_slli_epi64(x, SL1), b);
+            lung = _mm_xor_si128(_mm_shuffle_epi32(lung, 0x1B), z);
+            __m128i v = _mm_xor_si128(_mm_srli_epi64(lung, SR), x);
+            _mm_store_si128(&s[i], _mm_xor_si128(v, _mm_and_si128(lung, mask)));
+        }
+        _mm_store_si128(&s[N], lung);
+#else
+        gen_rand_all_scalar(st);
+#endif
+    }
+
+private:
+    State state;
+    int idx;  // 次に返す出力語の位置（N64 なら再生成が必要）
+
+    inline const uint64_t *words() const { return &state.u[0][0]; }
+
+public:
+    explicit Dsfmt19937(uint64_t seed) : state(init_state((uint32_t)seed)), idx(N64) {}
+
+    inline uint64_t next() {
+        if (idx >= N64) {
+            gen_rand_all(state);
+            idx = 0;
+        }
+        return (words()[idx++] & LOW_MASK) << 12;
+    }
+
+    /**
+     * n 個まとめて生成（状態の [1, 2) の倍精度から 1.0 を引いてコピーするだけ）
+     */
+    inline void fill_double(double *out, size_t n) {
+        while (n > 0) {
+            if (idx >= N64) {
+                gen_rand_all(state);
+                idx = 0;
+            }
+            size_t m = (n < (size_t)(N64 - idx)) ? n : (size_t)(N64 - idx);
+            const uint64_t *src = words() + idx;
+            for (size_t i = 0; i < m; i++) {
+                double d;
+                std::memcpy(&d, &src[i], sizeof(double));
+                out[i] = d - 1.0;
+            }
+            out += m;
+            n -= m;
+            idx += (int)m;
+        }
+    }
+
+    inline void discard(uint64_t n) {
+        uint64_t remaining = (uint64_t)(N64 - idx);
+        if (n < remaining) {
+            idx += (int)n;
+            return;
+        }
+        n -= remaining;
+        for (uint64_t i = 0; i < n / N64; i++) gen_rand_all(state);
+        idx = N64;
+        if (n % N64 != 0) {
+            gen_rand_all(state);
+            idx = (int)(n % N64);
+        }
+    }
+};
+
+namespace engines_detail {
+
+// 参照実装の出力（dSFMT.19937.out.txt、init_gen_rand(0) の先頭 1.030581026769374, 1.213140320067012, ...）
+constexpr bool dsfmt_kat() {
+    Dsfmt19937::State st = Dsfmt19937::init_state(0);
+    Dsfmt19937::gen_rand_all_scalar(st);
+    return st.u[0][0] == 0x3FF07D4287DDA41AULL && st.u[0][1] == 0x3FF36905D3025940ULL &&
+           st.u[1][0] == 0x3FF4C8B6DF25D7A5ULL;
+}
+
+static_assert(dsfmt_kat(), "dSFMT-19937 KAT");
+
+}  // namespace engines_detail
+
+#endif /* DSFMT_HPP */
@@ -0,0 +1,376 @@
+#ifndef ENGINE_REGISTRY_HPP
+#define ENGINE_REGISTRY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include "xoshiro256.hpp"
+#include "engines.hpp"
+#include "counter_engines.hpp"
+#include "chacha.hpp"
+#include "dsfmt.hpp"
+#include "qmc_engines.hpp"
+#include "pi_kernels.hpp"
+#include "estimators.hpp"
+
+/**
+ * 実行時にエンジン名からカーネルを選ぶためのレジストリ
+ * 
+ * テンプレートのカーネルをエンジンごとに実体化し、関数ポインタの表にする。
+ * 1つのバイナリで --engine=名前 により任意のエンジンを実行できる。
+ */
+
+/**
+ * カーネルの種類（pi_kernels.hpp）
+ */
+enum class Kernel {
+    Scalar,  // count_inside
+    Block,   // count_inside_block
+    Branchy,     // count_inside_branchy
+    Branchless,  // count_inside_branchless
+    Popcount,    // count_inside_popcount
+    Interleave2,  // count_inside_interleaved<2>
+    Interleave4,  // count_inside_interleaved<4>
+    Interleave8,  // count_inside_interleaved<8>
+    Int32,   // count_inside_packed<32>（1サンプル = 乱数1個）
+    Int26,   // count_inside_packed<26>（1サンプル = 乱数1個）
+    Int21,   // count_inside_packed<21>（3サンプル = 乱数2個）
+    Int16,   // count_inside_packed<16>（2サンプル = 乱数1個）
+    Float,   // count_inside_float（1サンプル = 乱数1個、単精度）
+    EarlyOut8,   // count_inside_early_out<8>
+    EarlyOut10,  // count_inside_early_out<10>
+    EarlyOut12,  // count_inside_early_out<12>
+    Bitmap       // count_inside_bitmap（KernelConfig::bitmap の表を使う）
+};
+
+/**
+ * カーネルの実行時設定（全スレッドで共有、読み取り専用）
+ */
+struct KernelConfig {
+    Kernel kernel = Kernel::Scalar;
+    Estimator estimator = Estimator::HitMiss;  // HitMiss 以外では kernel は使わない
+    const CellBitmap *bitmap = nullptr;  // Kernel::Bitmap のときのセル分類の表
+    StrataLayout strata;                 // Estimator::Stratified のときの層の配置
+    ControlPolygon control;              // Estimator::ControlVariate のときの内接正多角形
+    uint64_t seed = 12345;               // 系列のシード（--scrambles の複製ごとに変える）
+};
+
+/**
+ * 整数版（ビットパック）カーネルか
+ */
+constexpr bool kernel_is_packed(Kernel kernel) {
+    return kernel == Kernel::Int32 || kernel == Kernel::Int26 || kernel == Kernel::Int21 ||
+           kernel == Kernel::Int16;
+}
+
+/**
+ * next() の64ビットをそのまま座標に切り出すカーネルか（整数版・単精度版）
+ */
+constexpr bool kernel_uses_raw_words(Kernel kernel) {
+    return kernel_is_packed(kernel) || kernel == Kernel::Float;
+}
+
+/**
+ * 推定値 4 × (円内の点数) / n から引く量子化バイアス（倍精度のカーネルは0）
+ */
+constexpr double kernel_pi_bias(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Int32: return packed_pi_bias(32);
+    case Kernel::Int26: return packed_pi_bias(26);
+    case Kernel::Int21: return packed_pi_bias(21);
+    case Kernel::Int16: return packed_pi_bias(16);
+    case Kernel::Float: return float_pi_bias();
+    default: return 0.0;
+    }
+}
+
+/**
+ * 推定値（Moments の平均）から引くバイアス（当たり外れなら kernel_pi_bias）
+ */
+inline double estimator_pi_bias(const KernelConfig &config) {
+    if (config.estimator == Estimator::Stratified) return strata_pi_bias(config.strata);
+    return (config.estimator == Estimator::HitMiss) ? kernel_pi_bias(config.kernel) : 0.0;
+}
+
+/**
+ * 1サンプルあたりの乱数の個数
+ */
+constexpr double randoms_per_sample(const KernelConfig &config) {
+    if (config.estimator == Estimator::Conditional) return 1.0;
+    if (config.estimator == Estimator::Antithetic) return 2.0;
+    if (config.estimator == Estimator::Stratified) return 2.0;
+    if (config.estimator == Estimator::ControlVariate) return 2.0;
+    switch (config.kernel) {
+    case Kernel::Int32:
+    case Kernel::Int26:
+    case Kernel::Float: return 1.0;
+    case Kernel::Int21: return 2.0 / 3.0;
+    case Kernel::Int16: return 0.5;
+    default: return 2.0;
+    }
+}
+
+/**
+ * 統計を集計するチャンクのサンプル数（整数版のグループ 1, 3, 2 サンプルの公倍数）
+ * 
+ * チャンクの境界は系列上の絶対位置でこの倍数に揃えるので、途中のチャンクは必ず
+ * 整数版のグループの先頭から始まり、エンジンを作り直さずに続きから判定できる。
+ * 1チャンクは数ミリ秒かかるので、チャンクごとの集計のコストは無視できる。
+ */
+constexpr uint64_t CHUNK_SAMPLES = 3ULL << 20;
+
+/**
+ * 当たり外れで系列の first_sample 番目のサンプルより前にある乱数の数
+ * 
+ * 浮動小数点版は1サンプル = 乱数2個、単精度版は1個。
+ * 整数版はグループ（PackedTier::DRAWS_PER_GROUP 個）の先頭までの数で、
+ * グループ内の位置は count_inside_kernel() がカーネルの offset として渡す
+ */
+inline uint64_t hit_miss_draws(uint64_t first_sample, Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Int32:
+        return first_sample / PackedTier<32>::SAMPLES_PER_GROUP * PackedTier<32>::DRAWS_PER_GROUP;
+    case Kernel::Int26:
+        return first_sample / PackedTier<26>::SAMPLES_PER_GROUP * PackedTier<26>::DRAWS_PER_GROUP;
+    case Kernel::Int21:
+        return first_sample / PackedTier<21>::SAMPLES_PER_GROUP * PackedTier<21>::DRAWS_PER_GROUP;
+    case Kernel::Int16:
+        return first_sample / PackedTier<16>::SAMPLES_PER_GROUP * PackedTier<16>::DRAWS_PER_GROUP;
+    case Kernel::Float:
+        return first_sample;
+    default:
+        return 2 * first_sample;
+    }
+}
+
+/**
+ * hit_miss_draws() 個進めて first_sample の位置にあるエンジンで n サンプルを判定
+ * 
+ * @param rng 乱数生成器（n サンプル分進む、整数版は使ったグループの分）
+ * @param first_sample 開始サンプル番号（整数版のグループ内の位置に使う）
+ * @param n サンプル数
+ * @param config カーネルの種類と設定
+ * @return 円内の点数
+ */
+template <class Engine>
+uint64_t count_inside_kernel(Engine &rng, uint64_t first_sample, uint64_t n, const KernelConfig &config) {
+    switch (config.kernel) {
+    case Kernel::Int32:
+        return count_inside_packed<32>(rng, first_sample % PackedTier<32>::SAMPLES_PER_GROUP, n);
+    case Kernel::Int26:
+        return count_inside_packed<26>(rng, first_sample % PackedTier<26>::SAMPLES_PER_GROUP, n);
+    case Kernel::Int21:
+        return count_inside_packed<21>(rng, first_sample % PackedTier<21>::SAMPLES_PER_GROUP, n);
+    case Kernel::Int16:
+        return count_inside_packed<16>(rng, first_sample % PackedTier<16>::SAMPLES_PER_GROUP, n);
+    case Kernel::Float:
+        return count_inside_float(rng, n);
+    case Kernel::Block:
+        return count_inside_block(rng, n);
+    case Kernel::Branchy:
+        return count_inside_branchy(rng, n);
+    case Kernel::Branchless:
+        return count_inside_branchless(rng, n);
+    case Kernel::Popcount:
+        return count_inside_popcount(rng, n);
+    case Kernel::Interleave2:
+        return count_inside_interleaved<2>(rng, n);
+    case Kernel::Interleave4:
+        return count_inside_interleaved<4>(rng, n);
+    case Kernel::Interleave8:
+        return count_inside_interleaved<8>(rng, n);
+    case Kernel::EarlyOut8:
+        return count_inside_early_out<8>(rng, n);
+    case Kernel::EarlyOut10:
+        return count_inside_early_out<10>(rng, n);
+    case Kernel::EarlyOut12:
+        return count_inside_early_out<12>(rng, n);
+    case Kernel::Bitmap:
+        return count_inside_bitmap(rng, *config.bitmap, n);
+    case Kernel::Scalar:
+    default:
+        return count_inside(rng, n);
+    }
+}
+
+/**
+ * 推定量で系列の first_sample 番目のサンプルより前にある乱数の数（層別以外）
+ * 
+ * 条件付き推定量は1サンプル = 乱数1個、対称変量は1組・制御変量は1サンプル = 乱数2個、
+ * 当たり外れはカーネルごと（hit_miss_draws）。どの推定量・カーネルも、CHUNK_SAMPLES の
+ * 倍数の位置から始めたチャンクのあとはエンジンがちょうど終わりの位置の乱数を指すので、
+ * 次のチャンクへは差の分だけ discard すればよい
+ */
+inline uint64_t sample_draws(uint64_t first_sample, const KernelConfig &config) {
+    switch (config.estimator) {
+    case Estimator::Conditional:
+        return first_sample;
+    case Estimator::Antithetic:
+    case Estimator::ControlVariate:
+        return 2 * first_sample;
+    case Estimator::HitMiss:
+    default:
+        return hit_miss_draws(first_sample, config.kernel);
+    }
+}
+
+/**
+ * sample_draws() 個進めて first_sample の位置にあるエンジンで n サンプルの和と二乗和を求める（層別以外）
+ */
+template <class Engine>
+Moments estimate_chunk(Engine &rng, uint64_t first_sample, uint64_t n, const KernelConfig &config) {
+    switch (config.estimator) {
+    case Estimator::Conditional:
+        return estimate_conditional(rng, n);
+    case Estimator::Antithetic:
+        return estimate_antithetic(rng, n);
+    case Estimator::ControlVariate:
+        return estimate_control_variate(rng, n, config.control);
+    case Estimator::HitMiss:
+    default:
+        return hit_miss_moments(count_inside_kernel(rng, first_sample, n, config), n);
+    }
+}
+
+/**
+ * 指定したエンジン・推定量で、系列の first_sample 番目から n サンプルの和と二乗和を求める
+ * 
+ * エンジンは1回だけ作って区間の先頭まで進め、区間を CHUNK_SAMPLES の倍数の位置で区切った
+ * チャンクごとに推定量を呼んで、チャンクの結果を stats に足し込む（StreamingStats）。
+ * 層別はセル単位で割り当て、範囲内で始まる境界セルを丸ごと受け持つ
+ * （n の合計が config.strata.samples() なら、全スレッドで境界セルをちょうど1回ずつ数える）。
+ * チャンクは約 CHUNK_SAMPLES 点分のセルで、セルの位置（StrataCursor）を引き継ぐ。
+ * 
+ * @param seed シード（全スレッド共通のルート状態）
+ * @param first_sample 開始サンプル番号
+ * @param n サンプル数
+ * @param config 推定量・カーネルの種類と設定
+ * @param stats チャンク単位の統計（足し込む）
+ * @return サンプル値の和と二乗和（平均から estimator_pi_bias() を引くと推定値）
+ */
+using EstimateFn = Moments (*)(uint64_t seed, uint64_t first_sample, uint64_t n,
+                               const KernelConfig &config, StreamingStats &stats);
+
+template <class Engine>
+Moments estimate_with(uint64_t seed, uint64_t first_sample, uint64_t n, const KernelConfig &config,
+                      StreamingStats &stats) {
+    Engine rng(seed);
+    Moments total;
+
+    if (config.estimator == Estimator::Stratified) {
+        const uint64_t m = config.strata.samples_per_cell;
+        const uint64_t first_cell = (first_sample + m - 1) / m;
+        const uint64_t end_cell = (first_sample + n + m - 1) / m;
+        const uint64_t chunk_cells = (CHUNK_SAMPLES / m > 0) ? CHUNK_SAMPLES / m : 1;
+        rng.discard(2 * m * first_cell);
+        StrataCursor cursor = locate_strata_cell(config.strata, first_cell);
+        for (uint64_t cell = first_cell; cell < end_cell;) {
+            uint64_t cells = (end_cell - cell < chunk_cells) ? end_cell - cell : chunk_cells;
+            Moments chunk = estimate_stratified(rng, config.strata, cursor, cells);
+            stats.add_chunk(chunk);
+            total.add(chunk);
+            cell += cells;
+        }
+        return total;
+    }
+
+    rng.discard(sample_draws(first_sample, config));
+    const uint64_t end = first_sample + n;
+    for (uint64_t sample = first_sample; sample < end;) {
+        uint64_t boundary = (sample / CHUNK_SAMPLES + 1) * CHUNK_SAMPLES;
+        uint64_t chunk_end = (boundary < end) ? boundary : end;
+        Moments chunk = estimate_chunk(rng, sample, chunk_end - sample, config);
+        stats.add_chunk(chunk);
+        total.add(chunk);
+        sample = chunk_end;
+    }
+    return total;
+}
+
+/**
+ * 目標精度モードのチャンクの割り当てと結果の受け取り（monte_carlo_parallel.cpp が実装）
+ */
+class ChunkQueue {
+public:
+    /**
+     * 次のチャンクを取る（スレッドごとに first_sample は増えていく、もうなければ false）
+     */
+    virtual bool claim(uint64_t &first_sample, uint64_t &n) = 0;
+
+    /**
+     * 終わったチャンクの結果を渡す
+     */
+    virtual void publish(const Moments &moments, const StreamingStats &stats) = 0;
+
+protected:
+    ~ChunkQueue() = default;
+};
+
+/**
+ * queue から取ったチャンクを順に推定し、結果を queue に渡す（層別以外、1スレッド分）
+ * 
+ * エンジンはスレッドごとに1回だけ作り、次に取ったチャンクまでの間（他のスレッドが取ったチャンク）
+ * だけ discard する。discard が O(n) のエンジン（dSFMT など）でも、ルートから毎回進め直す
+ * 場合と違って、1スレッドの discard の合計は系列の長さを超えない。
+ * 
+ * @param seed シード（全スレッド共通のルート状態）
+ * @param config 推定量・カーネルの種類と設定
+ * @param queue チャンクの割り当てと結果の受け取り
+ */
+using EstimateChunksFn = void (*)(uint64_t seed, const KernelConfig &config, ChunkQueue &queue);
+
+template <class Engine>
+void estimate_chunks_with(uint64_t seed, const KernelConfig &config, ChunkQueue &queue) {
+    Engine rng(seed);
+    uint64_t position = 0;  // rng が指している乱数のサンプル番号
+    uint64_t first_sample, n;
+    while (queue.claim(first_sample, n)) {
+        rng.discard(sample_draws(first_sample, config) - sample_draws(position, config));
+        StreamingStats stats;
+        Moments chunk = estimate_chunk(rng, first_sample, n, config);
+        stats.add_chunk(chunk);
+        position = first_sample + n;
+        queue.publish(chunk, stats);
+    }
+}
+
+/**
+ * レジストリの1エントリ
+ */
+struct EngineEntry {
+    const char *name;                  // --engine= に指定する名前
+    EstimateFn estimate;               // テンプレートの実体（推定量の和と二乗和とチャンク単位の統計）
+    EstimateChunksFn estimate_chunks;  // 目標精度モードのスレッド（estimate_chunks_with）
+    int output_bits;                   // next() のうち乱数のビット数（整数版カーネルは64が必要）
+    bool point_pairs = false;          // next() が2次元の点の x, y を交互に返す低食い違い列か（qmc_engines.hpp）
+};
+
+inline const EngineEntry ENGINE_REGISTRY[] = {
+    {"xoshiro256ss", estimate_with<Xoshiro256>, estimate_chunks_with<Xoshiro256>, 64},  // Xoshiro256**（既定、他言語と同じ）
+    {"xoshiro256p", estimate_with<Xoshiro256Plus>, estimate_chunks_with<Xoshiro256Plus>, 64},
+    {"xoroshiro128p", estimate_with<Xoroshiro128Plus>, estimate_chunks_with<Xoroshiro128Plus>, 64},
+    {"splitmix64", estimate_with<SplitMix64>, estimate_chunks_with<SplitMix64>, 64},
+    {"pcg64", estimate_with<Pcg64>, estimate_chunks_with<Pcg64>, 64},
+    {"wyrand", estimate_with<Wyrand>, estimate_chunks_with<Wyrand>, 64},
+    {"philox4x64", estimate_with<Philox4x64>, estimate_chunks_with<Philox4x64>, 64},  // カウンタ型（counter_engines.hpp）
+    {"hash64", estimate_with<HashCounter64>, estimate_chunks_with<HashCounter64>, 64},
+    {"chacha8", estimate_with<ChaCha8>, estimate_chunks_with<ChaCha8>, 64},  // 暗号品質の比較用（chacha.hpp）
+    {"chacha12", estimate_with<ChaCha12>, estimate_chunks_with<ChaCha12>, 64},
+    {"dsfmt19937", estimate_with<Dsfmt19937>, estimate_chunks_with<Dsfmt19937>, 52},  // SIMD指向MT（dsfmt.hpp）
+    {"sobol2d", estimate_with<Sobol2D>, estimate_chunks_with<Sobol2D>, 64, true},  // 準モンテカルロ（qmc_engines.hpp）
+    {"r2", estimate_with<R2Sequence>, estimate_chunks_with<R2Sequence>, 64, true},
+};
+
+/**
+ * 名前でエンジンを探す
+ * 
+ * @param name エンジン名
+ * @return 見つかったエントリ（なければ nullptr）
+ */
+inline const EngineEntry *find_engine(const char *name) {
+    for (const EngineEntry &entry : ENGINE_REGISTRY) {
+        if (std::strcmp(entry.name, name) == 0) return &entry;
+    }
+    return nullptr;
+}
+
+#endif /* ENGINE_REGISTRY_HPP */
@@ -0,0 +1,342 @@
+#ifndef ENGINES_HPP
+#define ENGINES_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include "xoshiro256.hpp"
+#include "gf2_poly.hpp"
+
+/**
+ * 円周率カーネル用の乱数エンジン群（ヘッダオンリー）
+ *
+ * エンジンの要件（pi_kernels.hpp のテンプレートが使うインターフェース）:
+ * - explicit Engine(uint64_t seed)       シードから初期化
+ * - uint64_t next()                      64ビット乱数
+ * - double next_double()                 [0, 1) の倍精度（(next() >> 11) * 2^-53）
+ * - void fill_double(double *, size_t)   next_double() を n 回呼んだのと同じ値
+ * - void fill(uint64_t *, size_t)       next() を n 回呼んだのと同じ値
+ * - void discard(uint64_t n)             next() を n 回呼んだのと同じ状態に進める
+ *
+ * next_double() / fill_double() / fill() は EngineBase が next() から導出する。
+ * Xoshiro256（xoshiro256.hpp）も同じインターフェースを満たす。
+ *
+ * 各エンジンの特徴:
+ * - xoshiro256+   : Xoshiro256** と同じ状態遷移で、スクランブラが加算1回だけ。
+ *                   下位ビットの品質は落ちるが、上位53ビットを使う倍精度には十分
+ * - xoroshiro128+ : 状態128ビット。遷移が短く、倍精度用途では最速候補
+ * - SplitMix64    : 状態64ビットのカウンタ＋ミキサー。discard() は加算1回
+ * - PCG64         : 128ビットLCG＋XSL-RR出力。乗算は128ビット
+ * - wyrand        : 64×64→128ビット乗算1回のカウンタ型。discard() は加算1回
+ */
+
+/**
+ * next() から next_double() / fill_double() / fill() を導出する共通基底（CRTP）
+ */
+template <class Derived>
+class EngineBase {
+public:
+    /**
+     * 0.0以上1.0未満の浮動小数点数を生成
+     *
+     * @return 乱数（0.0 <= x < 1.0）
+     */
+    constexpr double next_double() {
+        return (self().next() >> 11) * (1.0 / (1ULL << 53));
+    }
+
+    /**
+     * 0.0以上1.0未満の浮動小数点数を n 個まとめて生成
+     *
+     * @param out 出力先（n 要素）
+     * @param n 生成する個数
+     */
+    inline void fill_double(double *out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = u64_to_double(self().next());
+        }
+    }
+
+    /**
+     * 64ビット乱数を n 個まとめて生成
+     *
+     * @param out 出力先（n 要素）
+     * @param n 生成する個数
+     */
+    inline void fill(uint64_t *out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = self().next();
+        }
+    }
+
+private:
+    constexpr Derived &self() { return static_cast<Derived &>(*this); }
+};
+
+/**
+ * SplitMix64（状態64ビット、Xoroshiro系のシード展開にも使う）
+ */
+class SplitMix64 : public EngineBase<SplitMix64> {
+private:
+    static constexpr uint64_t GAMMA = 0x9E3779B97F4A7C15ULL;  // 黄金比の逆数（64ビット）
+    uint64_t state;
+
+public:
+    constexpr explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    constexpr uint64_t next() {
+        uint64_t z = (state += GAMMA);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    constexpr void discard(uint64_t n) { state += n * GAMMA; }
+};
+
+/**
+ * xoshiro256+（Xoshiro256** と同じ状態遷移、出力は state[0] + state[3]）
+ */
+class Xoshiro256Plus : public EngineBase<Xoshiro256Plus> {
+private:
+    Xoshiro256 core;  // 状態遷移・jump・discard を共有（** の出力計算は最適化で消える）
+
+public:
+    constexpr explicit Xoshiro256Plus(uint64_t seed) : core(seed) {}
+    constexpr Xoshiro256Plus(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3)
+        : core(s0, s1, s2, s3) {}
+
+    constexpr uint64_t next() {
+        const uint64_t *s = core.get_state();
+        uint64_t result = s[0] + s[3];
+        core.next();
+        return result;
+    }
+
+    void discard(uint64_t n) { core.discard(n); }
+    void jump() { core.jump(); }
+};
+
+/**
+ * xoroshiro128+（2018年版のパラメータ 24, 16, 37）
+ */
+class Xoroshiro128Plus : public EngineBase<Xoroshiro128Plus> {
+public:
+    /**
+     * コンパイル時計算用の状態（gf2_minimal_polynomial が s[0] の最下位ビットを読む）
+     */
+    struct LinearState {
+        uint64_t s[2];
+    };
+
+    struct LinearStep {
+        constexpr void operator()(LinearState &st) const {
+            uint64_t s0 = st.s[0];
+            uint64_t s1 = st.s[1] ^ s0;
+            st.s[0] = rotl(s0, 24) ^ s1 ^ (s1 << 16);
+            st.s[1] = rotl(s1, 37);
+        }
+    };
+
+private:
+    uint64_t s0, s1;
+
+public:
+    /**
+     * SplitMix64 でシードを128ビットの状態に展開
+     */
+    constexpr explicit Xoroshiro128Plus(uint64_t seed) : s0(0), s1(0) {
+        SplitMix64 sm(seed);
+        s0 = sm.next();
+        s1 = sm.next();
+    }
+    constexpr Xoroshiro128Plus(uint64_t a, uint64_t b) : s0(a), s1(b) {}
+
+    constexpr uint64_t next() {
+        uint64_t result = s0 + s1;
+        LinearState st = {{s0, s1}};
+        LinearStep{}(st);
+        s0 = st.s[0];
+        s1 = st.s[1];
+        return result;
+    }
+
+    /**
+     * 多項式 poly(T) を状態に適用（Xoshiro256::jump_with() と同じ方式）
+     */
+    constexpr void jump_with(const uint64_t poly[2]) {
+        uint64_t a = 0, b = 0;
+        for (int i = 0; i < 2; i++) {
+            for (int bit = 0; bit < 64; bit++) {
+                if (poly[i] & (1ULL << bit)) {
+                    a ^= s0;
+                    b ^= s1;
+                }
+                next();
+            }
+        }
+        s0 = a;
+        s1 = b;
+    }
+
+    /**
+     * 2^64 回分進める（参照実装の JUMP 多項式）
+     */
+    void jump();
+
+    /**
+     * n 回分進める（O(log n)、2^k 回ジャンプの表はコンパイル時に計算）
+     */
+    void discard(uint64_t n);
+};
+
+namespace engines_detail {
+
+// 参照実装のジャンプ多項式（2^64, 2^96）
+constexpr uint64_t XOROSHIRO128_JUMP[2] = {0xDF900294D8F554A5ULL, 0x170865DF4B3201FCULL};
+constexpr uint64_t XOROSHIRO128_LONG_JUMP[2] = {0xD2A98B26625EEE7BULL, 0xDDDF9B1090AA7AC1ULL};
+
+// xoroshiro128+ の状態遷移の最小多項式（次数128）と 2^k 回ジャンプの表
+constexpr Gf2Poly<2> XOROSHIRO128_MINIMAL_POLY = gf2_minimal_polynomial<2>(
+    Xoroshiro128Plus::LinearState{{1, 2}}, Xoroshiro128Plus::LinearStep{});
+constexpr Gf2JumpTable<2, 64> XOROSHIRO128_POW2_JUMPS =
+    gf2_jump_table<2, 64>(XOROSHIRO128_MINIMAL_POLY);
+
+static_assert(gf2_equal(gf2_x_pow2(64, XOROSHIRO128_MINIMAL_POLY), XOROSHIRO128_JUMP),
+              "x^(2^64) mod m(x) must match the reference xoroshiro128 JUMP polynomial");
+static_assert(gf2_equal(gf2_x_pow2(96, XOROSHIRO128_MINIMAL_POLY), XOROSHIRO128_LONG_JUMP),
+              "x^(2^96) mod m(x) must match the reference xoroshiro128 LONG_JUMP polynomial");
+
+}  // namespace engines_detail
+
+inline void Xoroshiro128Plus::jump() {
+    jump_with(engines_detail::XOROSHIRO128_JUMP);
+}
+
+inline void Xoroshiro128Plus::discard(uint64_t n) {
+    // 下位7ビットは直接進め、上位ビットは表の多項式（1回128ステップ）で進める
+    for (uint64_t i = 0; i < (n & 127); i++) {
+        next();
+    }
+    for (int k = 7; k < 64; k++) {
+        if (n & (1ULL << k)) {
+            jump_with(engines_detail::XOROSHIRO128_POW2_JUMPS.pow2[k].words);
+        }
+    }
+}
+
+/**
+ * PCG64（PCG-XSL-RR 128/64、pcg-c の pcg64 と同じ系列）
+ */
+class Pcg64 : public EngineBase<Pcg64> {
+private:
+    using u128 = unsigned __int128;
+    static constexpr u128 MULTIPLIER =
+        ((u128)0x2360ED051FC65DA4ULL << 64) | 0x4385DF649FCCF645ULL;
+    static constexpr u128 DEFAULT_STREAM =
+        ((u128)0x2C28FA16A64ABF96ULL << 64) | 0x8A02BDBF7BB3C0A7ULL;  // pcg-c の既定増分 >> 1
+    u128 state;
+    u128 inc;
+
+    constexpr void step() { state = state * MULTIPLIER + inc; }
+
+public:
+    constexpr explicit Pcg64(uint64_t seed) : Pcg64(seed, DEFAULT_STREAM) {}
+
+    /**
+     * pcg-c の pcg64_srandom_r(initstate, initseq) と同じ初期化
+     */
+    constexpr Pcg64(u128 initstate, u128 initseq) : state(0), inc((initseq << 1) | 1) {
+        step();
+        state += initstate;
+        step();
+    }
+
+    constexpr uint64_t next() {
+        step();
+        uint64_t x = (uint64_t)(state >> 64) ^ (uint64_t)state;
+        unsigned rot = (unsigned)(state >> 122);
+        return (x >> rot) | (x << ((0u - rot) & 63));
+    }
+
+    /**
+     * n 回分進める（LCGの合成を二乗で求める、O(log n)）
+     */
+    constexpr void discard(uint64_t n) {
+        u128 acc_mult = 1, acc_plus = 0;
+        u128 cur_mult = MULTIPLIER, cur_plus = inc;
+        while (n > 0) {
+            if (n & 1) {
+                acc_mult *= cur_mult;
+                acc_plus = acc_plus * cur_mult + cur_plus;
+            }
+            cur_plus = (cur_mult + 1) * cur_plus;
+            cur_mult *= cur_mult;
+            n >>= 1;
+        }
+        state = acc_mult * state + acc_plus;
+    }
+};
+
+/**
+ * wyrand（カウンタ＋128ビット乗算ミキサー）
+ */
+class Wyrand : public EngineBase<Wyrand> {
+private:
+    static constexpr uint64_t INCREMENT = 0xA0761D6478BD642FULL;
+    uint64_t state;
+
+public:
+    constexpr explicit Wyrand(uint64_t seed) : state(seed) {}
+
+    constexpr uint64_t next() {
+        state += INCREMENT;
+        unsigned __int128 t = (unsigned __int128)state * (state ^ 0xE7037ED1A0B428DBULL);
+        return (uint64_t)(t >> 64) ^ (uint64_t)t;
+    }
+
+    constexpr void discard(uint64_t n) { state += n * INCREMENT; }
+};
+
+/**
+ * 既知解チェック（known-answer tests）
+ *
+ * 参照実装（各アルゴリズムの作者によるCコード）と同じ出力になることをコンパイル時に検証する
+ */
+namespace engines_detail {
+
+template <class Engine>
+constexpr uint64_t nth_output(Engine rng, int index) {
+    for (int i = 0; i < index; i++) rng.next();
+    return rng.next();
+}
+
+template <class Engine>
+constexpr uint64_t nth_output_after_discard(Engine rng, uint64_t skip) {
+    rng.discard(skip);
+    return rng.next();
+}
+
+static_assert(nth_output(SplitMix64(1234567), 0) == 6457827717110365317ULL, "SplitMix64 KAT");
+static_assert(nth_output(SplitMix64(1234567), 2) == 9817491932198370423ULL, "SplitMix64 KAT");
+static_assert(nth_output(Xoshiro256(1, 2, 3, 4), 0) == 11520ULL, "xoshiro256** KAT");
+static_assert(nth_output(Xoshiro256(1, 2, 3, 4), 3) == 1215971899390074240ULL, "xoshiro256** KAT");
+static_assert(nth_output(Xoshiro256Plus(1, 2, 3, 4), 0) == 5ULL, "xoshiro256+ KAT");
+static_assert(nth_output(Xoshiro256Plus(1, 2, 3, 4), 2) == 211106635186183ULL, "xoshiro256+ KAT");
+static_assert(nth_output(Xoroshiro128Plus(1, 2), 1) == 412333834243ULL, "xoroshiro128+ KAT");
+static_assert(nth_output(Xoroshiro128Plus(1, 2), 2) == 2360170716294286339ULL, "xoroshiro128+ KAT");
+static_assert(nth_output(Pcg64(42, 54), 0) == 0x86B1DA1D72062B68ULL, "PCG64 KAT (pcg64 demo)");
+static_assert(nth_output(Pcg64(42, 54), 2) == 0xA3670E9E0DD50358ULL, "PCG64 KAT (pcg64 demo)");
+static_assert(nth_output(Wyrand(42), 0) == 12558987674375533620ULL, "wyrand KAT");
+static_assert(nth_output(Wyrand(42), 2) == 14652274819296609082ULL, "wyrand KAT");
+
+// discard() が next() の繰り返しと一致すること（定数時間・O(log n) の実装）
+static_assert(nth_output_after_discard(SplitMix64(7), 1000) == nth_output(SplitMix64(7), 1000),
+              "SplitMix64 discard");
+static_assert(nth_output_after_discard(Pcg64(42, 54), 1000) == nth_output(Pcg64(42, 54), 1000),
+              "PCG64 discard");
+static_assert(nth_output_after_discard(Wyrand(7), 1000) == nth_output(Wyrand(7), 1000),
+              "wyrand discard");
+
+}  // namespace engines_detail
+
+#endif /* ENGINES_HPP */
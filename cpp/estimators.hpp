@@ -0,0 +1,678 @@
+#ifndef ESTIMATORS_HPP
+#define ESTIMATORS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include "pi_kernels.hpp"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 円周率の推定量
+ *
+ * どの推定量も「1サンプルの値 f_i の平均が π になる」形で表し、
+ * 和と二乗和（Moments）を返す。平均が推定値、分散からサンプルあたりの
+ * ばらつき（標準誤差 = sqrt(分散 / n)）が分かるので、推定量どうしを
+ * 同じ精度に達するまでの時間で比べられる。
+ *
+ * - 当たり外れ（hit-or-miss）: f = 4 × [x^2 + y^2 <= 1]、乱数2個、分散 π(4 - π) ≈ 2.70
+ *   （pi_kernels.hpp のカーネルの点数から求める）
+ * - 条件付き（conditional）: f = 4 × sqrt(1 - x^2)、乱数1個、分散 32/3 - π^2 ≈ 0.797
+ *   （y について期待値を解析的に取ったもの。分散は当たり外れの約 1/3.4）
+ * - 対称変量（antithetic）: f = 2 × ([(x, y) が円内] + [(1 - x, 1 - y) が円内])、乱数2個、
+ *   1サンプル = 点の組。判定は x, y について単調なので組の2点は負に相関し、
+ *   乱数の個数あたりの分散が当たり外れより小さくなる
+ * - 層別（stratified）: [0, 1)^2 を S × S のセルに分け、円内・円外に完全に入るセルは
+ *   解析的に数え、円周が通る境界セル（約 2S 個）だけに m 点ずつジッタ点を打つ。
+ *   分散は層内の分散だけになり、サンプルは境界セルにしか使わない
+ * - 制御変量（control variate）: f = 4 × [x^2 + y^2 <= 1] に、面積が分かっている内接正多角形の
+ *   判定 g = 4 × [(x, y) が多角形内] を β をかけて引く。多角形は円にほぼ重なるので f と g の
+ *   相関が高く、残るのは円と多角形の間の細い領域のばらつきだけになる
+ */
+
+/**
+ * 推定量の種類
+ */
+enum class Estimator {
+    HitMiss,      // 当たり外れ（--kernel のカーネル）
+    Conditional,  // estimate_conditional
+    Antithetic,   // estimate_antithetic
+    Stratified,   // estimate_stratified（KernelConfig::strata の配置を使う）
+    ControlVariate  // estimate_control_variate（KernelConfig::control の多角形を使う）
+};
+
+/**
+ * サンプル値の和と二乗和（スレッド・チャンクごとに足し合わせられる）
+ *
+ * 層別のサンプルは層ごとに平均が違うので、全体の二乗和ではなく層内の分散
+ * （Σ_層 層のサンプル数 × 層内の不偏分散）を within_sq に足し込む。
+ * どの層も同じサンプル数なら、推定値の分散は within_sq / n^2 になる。
+ *
+ * 制御変量を使う推定量は、期待値 control_mean が分かっている g_i の和・二乗和と
+ * f_i g_i の和も足し込む。係数 β = Cov(f, g) / Var(g) は全スレッドを合わせた後に求め、
+ * 平均は f の平均 - β (g の平均 - control_mean)、分散は Var(f) (1 - ρ^2) になる。
+ */
+struct Moments {
+    uint64_t n = 0;           // サンプル数
+    double sum = 0.0;         // Σ f_i
+    double sum_sq = 0.0;      // Σ f_i^2
+    double within_sq = 0.0;   // 層別のときの層内の分散の和
+    bool stratified = false;
+    double control_sum = 0.0;     // Σ g_i
+    double control_sum_sq = 0.0;  // Σ g_i^2
+    double cross_sum = 0.0;       // Σ f_i g_i
+    double control_mean = 0.0;    // E[g]（既知の値）
+    bool controlled = false;
+
+    void add(const Moments &other) {
+        n += other.n;
+        sum += other.sum;
+        sum_sq += other.sum_sq;
+        within_sq += other.within_sq;
+        stratified = stratified || other.stratified;
+        control_sum += other.control_sum;
+        control_sum_sq += other.control_sum_sq;
+        cross_sum += other.cross_sum;
+        if (other.controlled) control_mean = other.control_mean;
+        controlled = controlled || other.controlled;
+    }
+
+    /**
+     * f の平均（制御変量で補正する前）
+     */
+    double raw_mean() const { return sum / (double)n; }
+
+    /**
+     * f のサンプルあたりの不偏分散（層別なら層内の分散をプールしたもの、制御変量で補正する前）
+     */
+    double raw_variance() const {
+        if (n < 2) return 0.0;
+        if (stratified) return within_sq / (double)n;
+        double m = raw_mean();
+        return (sum_sq - m * sum) / (double)(n - 1);
+    }
+
+    double control_variance() const {
+        if (n < 2) return 0.0;
+        return (control_sum_sq - control_sum * control_sum / (double)n) / (double)(n - 1);
+    }
+
+    double control_covariance() const {
+        if (n < 2) return 0.0;
+        return (cross_sum - sum * control_sum / (double)n) / (double)(n - 1);
+    }
+
+    /**
+     * 分散を最小にする制御変量の係数 β = Cov(f, g) / Var(g)
+     */
+    double control_coefficient() const {
+        double var_g = control_variance();
+        return (var_g > 0.0) ? control_covariance() / var_g : 0.0;
+    }
+
+    double mean() const {
+        if (!controlled) return raw_mean();
+        return raw_mean() - control_coefficient() * (control_sum / (double)n - control_mean);
+    }
+
+    /**
+     * サンプルあたりの分散（制御変量があれば f - β g の分散）
+     */
+    double variance() const {
+        if (!controlled) return raw_variance();
+        return raw_variance() - control_coefficient() * control_covariance();
+    }
+};
+
+/**
+ * Chan et al. の公式で合わせる平均と偏差平方和（制御変量なら g と f, g の偏差積和も）
+ */
+struct CentralMoments {
+    double mean = 0.0;          // f の平均
+    double m2 = 0.0;            // Σ (f_i - mean)^2
+    double control_mean = 0.0;  // g の平均
+    double control_m2 = 0.0;    // Σ (g_i - control_mean)^2
+    double cross_m2 = 0.0;      // Σ (f_i - mean)(g_i - control_mean)
+
+    /**
+     * n 個分の自分に n_b 個分の other を合わせる（between が false なら平均の差の項を足さない）
+     */
+    void combine(uint64_t n, const CentralMoments &other, uint64_t n_b, bool between) {
+        if (n_b == 0) return;
+        const double total = (double)(n + n_b);
+        const double delta = other.mean - mean;
+        const double control_delta = other.control_mean - control_mean;
+        const double weight = (double)n * (double)n_b / total;
+        mean += delta * ((double)n_b / total);
+        control_mean += control_delta * ((double)n_b / total);
+        m2 += other.m2;
+        control_m2 += other.control_m2;
+        cross_m2 += other.cross_m2;
+        if (between) {
+            m2 += delta * delta * weight;
+            control_m2 += control_delta * control_delta * weight;
+            cross_m2 += delta * control_delta * weight;
+        }
+    }
+
+    /**
+     * f - β g の偏差平方和（β = 0 なら m2）
+     */
+    double m2_with(double beta) const {
+        double value = m2 - 2.0 * beta * cross_m2 + beta * beta * control_m2;
+        return (value > 0.0) ? value : 0.0;
+    }
+};
+
+/**
+ * チャンク単位のストリーミング統計（平均と偏差平方和 M2）
+ *
+ * 推定量はチャンク（CHUNK_SAMPLES サンプル）ごとに Moments を返し、スレッドはそれを add_chunk() で、
+ * calculate_pi はスレッドごとの統計を merge() で合わせる。どちらも Chan et al. の並列版の公式
+ * M2 = M2_a + M2_b + δ^2 n_a n_b / n（δ は平均の差）で、Welford 法をチャンク単位にしたもの。
+ * 全体の和と二乗和から分散を出すときの桁落ちがなく、更新はチャンクごとに1回なので
+ * サンプルあたりのコストはかからない。
+ *
+ * チャンクの平均も1つの値として同じ公式で集計し（batch means）、チャンク平均の分散 / チャンク数
+ * からも標準誤差を出す。サンプルの独立性を仮定しないので、低食い違い列のように
+ * サンプルが相関する系列でも目安になる（端のチャンクは短いが、同じ重みで扱う）。
+ * 層別はチャンクごとに担当する層が違い平均が揃わないので、平均の差の項を足さない。
+ *
+ * 制御変量は f と g を別々に集計し（偏差積和も同じ公式で合わせる）、分散は合わせた後の
+ * β = Cov(f, g) / Var(g) で f - β g について求める。推定値（Moments::mean()）と同じ全体の β なので、
+ * std_error・信頼区間・目標精度モードの停止判定は出力する推定値そのものの誤差になる。
+ */
+struct StreamingStats {
+    uint64_t n = 0;            // サンプル数
+    CentralMoments samples;    // サンプル値の平均と偏差平方和
+    uint64_t batches = 0;      // チャンク数
+    CentralMoments batch;      // チャンク平均の平均と偏差平方和
+    bool stratified = false;
+    bool controlled = false;   // 制御変量（samples, batch に g も集計している）
+
+    /**
+     * チャンク1つの結果を足し込む
+     */
+    void add_chunk(const Moments &chunk) {
+        StreamingStats s;
+        const double df = (chunk.n > 1) ? (double)(chunk.n - 1) : 0.0;
+        s.n = chunk.n;
+        s.controlled = chunk.controlled;
+        if (chunk.controlled) {
+            s.samples.mean = chunk.raw_mean();
+            s.samples.m2 = chunk.raw_variance() * df;
+            s.samples.control_mean = chunk.control_sum / (double)chunk.n;
+            s.samples.control_m2 = chunk.control_variance() * df;
+            s.samples.cross_m2 = chunk.control_covariance() * df;
+        } else {
+            s.samples.mean = chunk.mean();
+            s.samples.m2 = chunk.variance() * df;
+        }
+        s.batches = 1;
+        s.batch.mean = s.samples.mean;
+        s.batch.control_mean = s.samples.control_mean;
+        s.stratified = chunk.stratified;
+        merge(s);
+    }
+
+    void merge(const StreamingStats &other) {
+        stratified = stratified || other.stratified;
+        controlled = controlled || other.controlled;
+        samples.combine(n, other.samples, other.n, !stratified);
+        batch.combine(batches, other.batch, other.batches, true);
+        n += other.n;
+        batches += other.batches;
+    }
+
+    /**
+     * 制御変量の係数 β（全チャンクを合わせた値、制御変量でなければ0）
+     */
+    double control_coefficient() const {
+        return (controlled && samples.control_m2 > 0.0) ? samples.cross_m2 / samples.control_m2 : 0.0;
+    }
+
+    double variance() const { return (n > 1) ? samples.m2_with(control_coefficient()) / (double)(n - 1) : 0.0; }
+
+    double std_error() const { return (n > 0) ? std::sqrt(variance() / (double)n) : 0.0; }
+
+    /**
+     * チャンク平均のばらつきによる標準誤差（チャンクが1つなら0）
+     */
+    double batch_std_error() const {
+        if (batches < 2) return 0.0;
+        return std::sqrt(batch.m2_with(control_coefficient()) / (double)(batches - 1) / (double)batches);
+    }
+};
+
+/**
+ * 当たり外れの点数から Moments を作る（f は 0 か 4 なので和・二乗和は点数から決まる）
+ */
+inline Moments hit_miss_moments(uint64_t inside_circle, uint64_t n) {
+    Moments m;
+    m.n = n;
+    m.sum = 4.0 * (double)inside_circle;
+    m.sum_sq = 16.0 * (double)inside_circle;
+    return m;
+}
+
+/**
+ * x の並び（n 個）について 4 × sqrt(1 - x^2) の和と二乗和を足し込む
+ *
+ * sqrt はベクトル命令（AVX-512 で8レーン、AVX2 で4レーン）で計算する。
+ * std::sqrt のままだと errno の扱いのためにスカラーの呼び出しが残り、ベクトル化されない
+ * （x < 1 なので 1 - x^2 は常に正）。
+ */
+inline void add_conditional_values(const double *xs, size_t n, double &sum, double &sum_sq) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d four = _mm512_set1_pd(4.0);
+    __m512d vsum = _mm512_setzero_pd();
+    __m512d vsum_sq = _mm512_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        __m512d x = _mm512_loadu_pd(xs + i);
+        __m512d f = _mm512_mul_pd(four, _mm512_sqrt_pd(_mm512_sub_pd(one, _mm512_mul_pd(x, x))));
+        vsum = _mm512_add_pd(vsum, f);
+        vsum_sq = _mm512_add_pd(vsum_sq, _mm512_mul_pd(f, f));
+    }
+    sum += _mm512_reduce_add_pd(vsum);
+    sum_sq += _mm512_reduce_add_pd(vsum_sq);
+#elif defined(__AVX2__)
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d four = _mm256_set1_pd(4.0);
+    __m256d vsum = _mm256_setzero_pd();
+    __m256d vsum_sq = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(xs + i);
+        __m256d f = _mm256_mul_pd(four, _mm256_sqrt_pd(_mm256_sub_pd(one, _mm256_mul_pd(x, x))));
+        vsum = _mm256_add_pd(vsum, f);
+        vsum_sq = _mm256_add_pd(vsum_sq, _mm256_mul_pd(f, f));
+    }
+    alignas(32) double lanes[4], lanes_sq[4];
+    _mm256_store_pd(lanes, vsum);
+    _mm256_store_pd(lanes_sq, vsum_sq);
+    sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    sum_sq += (lanes_sq[0] + lanes_sq[1]) + (lanes_sq[2] + lanes_sq[3]);
+#endif
+    for (; i < n; i++) {
+        double f = 4.0 * std::sqrt(1.0 - xs[i] * xs[i]);
+        sum += f;
+        sum_sq += f * f;
+    }
+}
+
+/**
+ * 条件付き推定量: 1サンプル = 乱数1個の x で 4 × sqrt(1 - x^2) の平均を取る
+ *
+ * 当たり外れの y を積分で消したもの（E[4 × [y <= sqrt(1 - x^2)] | x] = 4 × sqrt(1 - x^2)）。
+ * 乱数の消費が半分になり、サンプルあたりの分散も約 1/3.4 になる。
+ * ブロック版カーネルと同じく fill_double() で L1 サイズのバッファに生成してから計算する。
+ *
+ * @param rng 乱数生成器（n 個分進む）
+ * @param n サンプル数
+ * @return サンプル値の和と二乗和
+ */
+template <class Engine>
+inline Moments estimate_conditional(Engine &rng, uint64_t n) {
+    alignas(64) double buffer[BLOCK_DOUBLES];
+    Moments m;
+    m.n = n;
+
+    while (n > 0) {
+        size_t samples = (n < BLOCK_DOUBLES) ? (size_t)n : BLOCK_DOUBLES;
+        rng.fill_double(buffer, samples);
+        add_conditional_values(buffer, samples, m.sum, m.sum_sq);
+        n -= samples;
+    }
+
+    return m;
+}
+
+/**
+ * 対称変量の推定量: 点 (x, y) と (1 - x, 1 - y) の組を1サンプルとして判定
+ *
+ * 組の値は 0, 2, 4 のどれかなので、「片方だけ円内」「両方円内」の組の数を整数で数えれば
+ * 和と二乗和が決まる（判定のループは分岐なしでベクトル化される）。x = k × 2^-53 なので
+ * 1 - x は倍精度で正確に表せる。分散は組の値から求めるので、組の中の相関がそのまま反映される。
+ * 乱数の消費は当たり外れと同じ1サンプル = 乱数2個。
+ *
+ * @param rng 乱数生成器（n 組分進む）
+ * @param n 組の数
+ * @return 組の値の和と二乗和
+ */
+template <class Engine>
+inline Moments estimate_antithetic(Engine &rng, uint64_t n) {
+    alignas(64) double buffer[BLOCK_DOUBLES];
+    uint64_t one_inside = 0, both_inside = 0;
+    Moments m;
+    m.n = n;
+
+    while (n > 0) {
+        size_t samples = (n < BLOCK_DOUBLES / 2) ? (size_t)n : BLOCK_DOUBLES / 2;
+        rng.fill_double(buffer, 2 * samples);
+
+        uint64_t block_one = 0, block_both = 0;
+        for (size_t i = 0; i < samples; i++) {
+            double x = buffer[2 * i];
+            double y = buffer[2 * i + 1];
+            double u = 1.0 - x;
+            double v = 1.0 - y;
+            uint64_t a = (x * x + y * y <= 1.0);
+            uint64_t b = (u * u + v * v <= 1.0);
+            block_one += a ^ b;
+            block_both += a & b;
+        }
+        one_inside += block_one;
+        both_inside += block_both;
+        n -= samples;
+    }
+
+    m.sum = 2.0 * (double)one_inside + 4.0 * (double)both_inside;
+    m.sum_sq = 4.0 * (double)one_inside + 16.0 * (double)both_inside;
+    return m;
+}
+
+/**
+ * 対称変量の有効サンプル数（同じ標準誤差になる当たり外れのサンプル数）
+ *
+ * 当たり外れの1サンプルの分散は平均 m から m(4 - m) と推定できるので、
+ * n 組の分散 σ_g^2 / n と比べて n × m(4 - m) / σ_g^2 になる（組の分散が0なら0）。
+ */
+inline double antithetic_effective_samples(const Moments &moments) {
+    double m = moments.mean();
+    double variance = moments.variance();
+    return (variance > 0.0) ? (double)moments.n * m * (4.0 - m) / variance : 0.0;
+}
+
+/**
+ * 組の2点の判定の相関係数（σ_g^2 = σ^2 (1 + ρ) / 2 から求める、負なら分散が減る。点の分散が0なら0）
+ */
+inline double antithetic_correlation(const Moments &moments) {
+    double m = moments.mean();
+    double point_variance = m * (4.0 - m);
+    return (point_variance > 0.0) ? 2.0 * moments.variance() / point_variance - 1.0 : 0.0;
+}
+
+/**
+ * 層別の配置（S × S のセルのうち境界セルにだけ m 点ずつ打つ）
+ */
+struct StrataLayout {
+    static constexpr uint64_t MAX_STRATA = 1ULL << 31;  // S^2 が64ビットに収まる範囲
+    static constexpr uint64_t MAX_SAMPLES_PER_CELL = BLOCK_DOUBLES / 2;
+
+    uint64_t strata = 0;            // S（1軸あたりの分割数）
+    uint64_t samples_per_cell = 0;  // m（境界セル1つあたりの点数、2以上）
+    uint64_t inside_cells = 0;      // 円内に完全に入るセルの数
+    uint64_t boundary_cells = 0;    // 円周が通るセルの数
+
+    /**
+     * 使うサンプル数（境界セルの数 × m）
+     */
+    uint64_t samples() const { return boundary_cells * samples_per_cell; }
+};
+
+/**
+ * 64ビット整数の平方根（切り捨て）
+ */
+inline uint64_t isqrt64(uint64_t v) {
+    uint64_t r = (uint64_t)std::sqrt((double)v);
+    while (r * r > v) r--;
+    while ((r + 1) * (r + 1) <= v) r++;
+    return r;
+}
+
+/**
+ * 行 i（x が [i/S, (i+1)/S)）の境界セルの範囲 [in, out)
+ *
+ * j < in のセルは遠い角が円内 ((i+1)^2 + (j+1)^2 <= S^2) なので全点が円内、
+ * j >= out のセルは近い角が円外 (i^2 + j^2 > S^2) なので全点が円外。
+ * in < out なので、どの行にも境界セルが1つ以上ある。
+ */
+inline void strata_row(uint64_t s, uint64_t i, uint64_t &in, uint64_t &out) {
+    in = isqrt64(s * s - (i + 1) * (i + 1));
+    uint64_t o = isqrt64(s * s - i * i) + 1;
+    out = (o < s) ? o : s;
+}
+
+/**
+ * 配置を作る（全行の境界セルを数える、O(S)）
+ *
+ * @param strata S（0 なら iterations から、境界セルの点数の合計が iterations 程度になるように選ぶ）
+ * @param samples_per_cell m
+ * @param iterations 目安のサンプル数
+ */
+inline StrataLayout make_strata_layout(uint64_t strata, uint64_t samples_per_cell, uint64_t iterations) {
+    StrataLayout layout;
+    layout.samples_per_cell = samples_per_cell;
+    if (strata == 0) {
+        // 境界セルは約 2S 個
+        strata = iterations / (2 * samples_per_cell);
+        if (strata < 1) strata = 1;
+        if (strata > StrataLayout::MAX_STRATA) strata = StrataLayout::MAX_STRATA;
+    }
+    layout.strata = strata;
+    for (uint64_t i = 0; i < strata; i++) {
+        uint64_t in, out;
+        strata_row(strata, i, in, out);
+        layout.inside_cells += in;
+        layout.boundary_cells += out - in;
+    }
+    return layout;
+}
+
+/**
+ * 層別の推定値から引くバイアス（解析的に数えた円内のセルの分 -4I / S^2）
+ */
+inline double strata_pi_bias(const StrataLayout &layout) {
+    double s = (double)layout.strata;
+    return -4.0 * (double)layout.inside_cells / (s * s);
+}
+
+/**
+ * 層別の推定量が次に判定する境界セルの位置（行と列、チャンクをまたいで引き継ぐ）
+ */
+struct StrataCursor {
+    uint64_t row = 0;
+    uint64_t in = 0;   // 行 row の境界セルの範囲 [in, out)
+    uint64_t out = 0;
+    uint64_t col = 0;
+};
+
+/**
+ * 境界セル cell 番目の位置を探す（行ごとの境界セルの数を前から足す、O(行数)）
+ */
+inline StrataCursor locate_strata_cell(const StrataLayout &layout, uint64_t cell) {
+    const uint64_t s = layout.strata;
+    StrataCursor cursor;
+    uint64_t before = 0;
+    strata_row(s, cursor.row, cursor.in, cursor.out);
+    while (before + (cursor.out - cursor.in) <= cell && cursor.row + 1 < s) {
+        before += cursor.out - cursor.in;
+        strata_row(s, ++cursor.row, cursor.in, cursor.out);
+    }
+    cursor.col = cursor.in + (cell - before);
+    return cursor;
+}
+
+/**
+ * 層別の推定量: cursor の位置の境界セルから cells 個に m 点ずつジッタ点を打って判定
+ *
+ * 境界セルは行優先で番号を付け、セル c は系列の乱数 2m × c 番目から 2m 個を使う
+ * （呼び出し側が最初のセルの位置まで discard しておく）。どのスレッドにどのセルが割り当てられても
+ * 同じ点を打つので、結果はスレッド数によらない。
+ *
+ * 推定値 = 4I / S^2 + (4 / (S^2 m)) × Σ 円内の点数 なので、1点の値を w = 4B / S^2（円内）か
+ * 0（円外）として平均を取り、解析的な部分は strata_pi_bias() として引く。
+ * 点は L1 サイズのバッファ単位でセルの座標と一様乱数をまとめて作り、
+ * (セルの番号 + 乱数) / S の判定を分岐なしのループで行う。
+ *
+ * @param rng 乱数生成器（最初のセルの位置にあること、2m × cells 個分進む）
+ * @param layout 配置
+ * @param cursor 最初の境界セルの位置（locate_strata_cell、cells 個分進む）
+ * @param cells 境界セルの数
+ * @return サンプル値の和と層内の分散
+ */
+template <class Engine>
+inline Moments estimate_stratified(Engine &rng, const StrataLayout &layout, StrataCursor &cursor, uint64_t cells) {
+    const uint64_t s = layout.strata;
+    const uint64_t m = layout.samples_per_cell;
+    const double inv_s = 1.0 / (double)s;
+    const size_t block_cells = BLOCK_DOUBLES / (2 * m);
+    alignas(64) double buffer[BLOCK_DOUBLES];
+    double cell_x[BLOCK_DOUBLES / 4];
+    double cell_y[BLOCK_DOUBLES / 4];
+
+    uint64_t hits = 0;    // Σ h（h = セル内の円内の点数）
+    uint64_t spread = 0;  // Σ h(m - h)
+    Moments result;
+    result.n = cells * m;
+    result.stratified = true;
+
+    while (cells > 0) {
+        size_t count = (cells < block_cells) ? (size_t)cells : block_cells;
+        for (size_t k = 0; k < count; k++) {
+            cell_x[k] = (double)cursor.row;
+            cell_y[k] = (double)cursor.col;
+            if (++cursor.col == cursor.out && cursor.row + 1 < s) {
+                strata_row(s, ++cursor.row, cursor.in, cursor.out);
+                cursor.col = cursor.in;
+            }
+        }
+        rng.fill_double(buffer, 2 * m * count);
+
+        for (size_t k = 0; k < count; k++) {
+            const double *uv = &buffer[2 * m * k];
+            uint64_t h = 0;
+            for (uint64_t t = 0; t < m; t++) {
+                double x = (cell_x[k] + uv[2 * t]) * inv_s;
+                double y = (cell_y[k] + uv[2 * t + 1]) * inv_s;
+                h += (x * x + y * y <= 1.0);
+            }
+            hits += h;
+            spread += h * (m - h);
+        }
+        cells -= count;
+    }
+
+    double s2 = (double)s * (double)s;
+    double w = 4.0 * (double)layout.boundary_cells / s2;
+    result.sum = w * (double)hits;
+    result.within_sq = w * w * (double)spread / (double)(m - 1);
+    return result;
+}
+
+/**
+ * 制御変量に使う円の内接正多角形（第1象限の部分）
+ *
+ * 正 N 角形（N = 4K）の頂点を角度 0, π/(2K), ..., π/2 に置くと、第1象限の部分は
+ * 原点から見た K 個の三角形になり、面積は (K / 2) sin(π / (2K))（K = 1 なら内接正方形の
+ * 三角形 x + y <= 1、面積 1/2）。点が多角形内にあるのは、各辺の外向き法線
+ * (cos θ_j, sin θ_j)、θ_j = (j + 1/2) π / (2K) への射影がどれも cos(π / N) 以下のとき。
+ */
+struct ControlPolygon {
+    static constexpr int MAX_EDGES = 16;  // 正64角形まで
+
+    int sides = 0;                  // N
+    int edges = 0;                  // K = N / 4（第1象限の辺の数）
+    double normal_x[MAX_EDGES] = {};  // cos θ_j
+    double normal_y[MAX_EDGES] = {};  // sin θ_j
+    double apothem = 0.0;           // cos(π / N)（原点から辺までの距離）
+    double quarter_area = 0.0;      // 第1象限の部分の面積
+};
+
+/**
+ * 内接正 N 角形を作る（N は 4, 8, 16, 32, 64 のどれか）
+ */
+inline ControlPolygon make_control_polygon(int sides) {
+    const double pi = 3.141592653589793238462643383279502884197;
+    ControlPolygon polygon;
+    polygon.sides = sides;
+    polygon.edges = sides / 4;
+    for (int j = 0; j < polygon.edges; j++) {
+        double theta = (j + 0.5) * pi / (2.0 * polygon.edges);
+        polygon.normal_x[j] = std::cos(theta);
+        polygon.normal_y[j] = std::sin(theta);
+    }
+    polygon.apothem = std::cos(pi / sides);
+    polygon.quarter_area = 0.5 * polygon.edges * std::sin(pi / (2.0 * polygon.edges));
+    return polygon;
+}
+
+/**
+ * 制御変量の推定量（辺の数 K をテンプレート引数にして、辺のループを展開する）
+ *
+ * 1サンプルで円の判定 h と多角形の判定 c を分岐なしで求め、h, c, h & c の個数だけを
+ * ローカル変数（レジスタ）に数える。f = 4h, g = 4c は 0 か 4 なので、和・二乗和・積和は
+ * この3つの個数から決まり、サンプルごとにメモリへ書き出す値はない。
+ * 法線もローカルの配列に写してから使うので、ループ内の読み出しはバッファの乱数だけになる。
+ */
+template <int K, class Engine>
+inline Moments estimate_control_variate_edges(Engine &rng, uint64_t n, const ControlPolygon &polygon) {
+    alignas(64) double buffer[BLOCK_DOUBLES];
+    double nx[K], ny[K];
+    for (int j = 0; j < K; j++) {
+        nx[j] = polygon.normal_x[j];
+        ny[j] = polygon.normal_y[j];
+    }
+    const double apothem = polygon.apothem;
+    uint64_t hits = 0, controls = 0, both = 0;
+    Moments m;
+    m.n = n;
+
+    while (n > 0) {
+        size_t samples = (n < BLOCK_DOUBLES / 2) ? (size_t)n : BLOCK_DOUBLES / 2;
+        rng.fill_double(buffer, 2 * samples);
+
+        uint64_t block_hits = 0, block_controls = 0, block_both = 0;
+        for (size_t i = 0; i < samples; i++) {
+            double x = buffer[2 * i];
+            double y = buffer[2 * i + 1];
+            uint64_t h = (x * x + y * y <= 1.0);
+            uint64_t c = 1;
+            for (int j = 0; j < K; j++) {
+                c &= (x * nx[j] + y * ny[j] <= apothem);
+            }
+            block_hits += h;
+            block_controls += c;
+            block_both += h & c;
+        }
+        hits += block_hits;
+        controls += block_controls;
+        both += block_both;
+        n -= samples;
+    }
+
+    m.sum = 4.0 * (double)hits;
+    m.sum_sq = 16.0 * (double)hits;
+    m.control_sum = 4.0 * (double)controls;
+    m.control_sum_sq = 16.0 * (double)controls;
+    m.cross_sum = 16.0 * (double)both;
+    m.control_mean = 4.0 * polygon.quarter_area;
+    m.controlled = true;
+    return m;
+}
+
+/**
+ * 制御変量の推定量: 当たり外れの判定と内接正多角形の判定を同じ点で行う
+ *
+ * @param rng 乱数生成器（2n 個分進む）
+ * @param n サンプル数
+ * @param polygon 制御変量の多角形（make_control_polygon）
+ * @return f = 4h と g = 4c の和・二乗和・積和（平均・分散は β で補正済みの値になる）
+ */
+template <class Engine>
+inline Moments estimate_control_variate(Engine &rng, uint64_t n, const ControlPolygon &polygon) {
+    switch (polygon.edges) {
+    case 1: return estimate_control_variate_edges<1>(rng, n, polygon);
+    case 2: return estimate_control_variate_edges<2>(rng, n, polygon);
+    case 4: return estimate_control_variate_edges<4>(rng, n, polygon);
+    case 8: return estimate_control_variate_edges<8>(rng, n, polygon);
+    case 16:
+    default: return estimate_control_variate_edges<16>(rng, n, polygon);
+    }
+}
+
+#endif /* ESTIMATORS_HPP */
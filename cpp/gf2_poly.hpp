@@ -0,0 +1,145 @@
+#ifndef GF2_POLY_HPP
+#define GF2_POLY_HPP
+
+#include <cstdint>
+
+/**
+ * GF(2)上の多項式演算（線形生成器のジャンプ多項式をコンパイル時に求める）
+ *
+ * アルゴリズムの背景:
+ * - Xoshiro系の状態遷移 T は GF(2) 上の線形写像（XOR・シフト・ローテートのみ）
+ * - T の最小多項式 m(x)（次数 D = 状態ビット数）が分かれば、n 回進める T^n は
+ *   x^n mod m(x) = Σ c_j x^j を使って Σ c_j T^j と書ける
+ * - つまり「j 回進めた状態を c_j が1のときだけXORで足し込む」ことで、
+ *   D 回の遷移だけで任意の n 回分を進められる（参照実装の jump() と同じ形）
+ * - m(x) は出力ビット列に Berlekamp-Massey 法を適用して求める
+ *
+ * 多項式の表現:
+ * - Gf2Poly<W> は次数 64*W 未満の多項式、words[i] のビット b が x^(64*i+b) の係数
+ * - すべて constexpr なので、static constexpr の表としてコンパイル時に計算できる
+ */
+
+template <int W>
+struct Gf2Poly {
+    uint64_t words[W];
+};
+
+/**
+ * 線形遷移の最小多項式（次数 64*W、最高次の係数は省略して下位だけを保持）
+ *
+ * @param state 初期状態（ゼロ以外）
+ * @param step 状態を1回進める constexpr 関数オブジェクト
+ * @return m(x) の下位 64*W 次分の係数
+ */
+template <int W, class State, class Step>
+constexpr Gf2Poly<W> gf2_minimal_polynomial(State state, Step step) {
+    constexpr int D = 64 * W;
+    constexpr int N = 2 * D;
+
+    // 出力ビット列（状態の最下位ビット）を 2D 個集める
+    bool seq[N] = {};
+    for (int t = 0; t < N; t++) {
+        seq[t] = (state.s[0] & 1) != 0;
+        step(state);
+    }
+
+    // Berlekamp-Massey 法: 接続多項式 C(x) = 1 + c_1 x + ... + c_L x^L を求める
+    bool c[N + 1] = {};
+    bool b[N + 1] = {};
+    c[0] = true;
+    b[0] = true;
+    int length = 0;
+    int shift = 1;
+    for (int n = 0; n < N; n++) {
+        bool discrepancy = seq[n];
+        for (int i = 1; i <= length; i++) {
+            discrepancy ^= c[i] && seq[n - i];
+        }
+        if (!discrepancy) {
+            shift++;
+            continue;
+        }
+        bool prev[N + 1] = {};
+        for (int i = 0; i <= N; i++) prev[i] = c[i];
+        for (int i = 0; i + shift <= N; i++) c[i + shift] ^= b[i];
+        if (2 * length <= n) {
+            length = n + 1 - length;
+            for (int i = 0; i <= N; i++) b[i] = prev[i];
+            shift = 1;
+        } else {
+            shift++;
+        }
+    }
+
+    // m(x) = x^L C(1/x)、すなわち m_j = c_(L-j)。L = D でなければ呼び出し側で検出する
+    Gf2Poly<W> m = {};
+    for (int j = 0; j < D && j <= length; j++) {
+        if (c[length - j]) m.words[j / 64] |= 1ULL << (j % 64);
+    }
+    return m;
+}
+
+/**
+ * a * b mod m(x) を計算（m は最高次 x^(64*W) を省略した形）
+ */
+template <int W>
+constexpr Gf2Poly<W> gf2_mulmod(const Gf2Poly<W> &a, const Gf2Poly<W> &b, const Gf2Poly<W> &m) {
+    Gf2Poly<W> r = {};
+    for (int j = 64 * W - 1; j >= 0; j--) {
+        // r = r * x mod m
+        bool carry = (r.words[W - 1] >> 63) != 0;
+        for (int i = W - 1; i > 0; i--) {
+            r.words[i] = (r.words[i] << 1) | (r.words[i - 1] >> 63);
+        }
+        r.words[0] <<= 1;
+        if (carry) {
+            for (int i = 0; i < W; i++) r.words[i] ^= m.words[i];
+        }
+        // b の係数が1なら a を足す
+        if ((b.words[j / 64] >> (j % 64)) & 1) {
+            for (int i = 0; i < W; i++) r.words[i] ^= a.words[i];
+        }
+    }
+    return r;
+}
+
+/**
+ * x^(2^k) mod m(x) を計算（k 回の二乗）
+ */
+template <int W>
+constexpr Gf2Poly<W> gf2_x_pow2(int k, const Gf2Poly<W> &m) {
+    Gf2Poly<W> r = {};
+    r.words[0] = 2;  // x
+    for (int i = 0; i < k; i++) r = gf2_mulmod(r, r, m);
+    return r;
+}
+
+/**
+ * 2のべき乗ジャンプの表 x^(2^k) mod m(x)（k = 0..K-1）
+ */
+template <int W, int K>
+struct Gf2JumpTable {
+    Gf2Poly<W> pow2[K];
+};
+
+template <int W, int K>
+constexpr Gf2JumpTable<W, K> gf2_jump_table(const Gf2Poly<W> &m) {
+    Gf2JumpTable<W, K> table = {};
+    Gf2Poly<W> r = {};
+    r.words[0] = 2;  // x
+    for (int k = 0; k < K; k++) {
+        table.pow2[k] = r;
+        r = gf2_mulmod(r, r, m);
+    }
+    return table;
+}
+
+template <int W>
+constexpr bool gf2_equal(const Gf2Poly<W> &a, const uint64_t (&b)[W]) {
+    for (int i = 0; i < W; i++) {
+        if (a.words[i] != b[i]) return false;
+    }
+    return true;
+}
+
+#endif /* GF2_POLY_HPP */
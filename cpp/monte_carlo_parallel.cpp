@@ -1,52 +1,49 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
-#include <ctime>
+#include <chrono>
 #include <thread>
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <algorithm>
-#include "xoshiro256.hpp"
+#include "engine_registry.hpp"
+#include "bench_options.hpp"
+
+// JSONに記録するコンパイラフラグ（LTOなしビルドでは Makefile から上書き）
+#ifndef PI_COMPILER_FLAGS
+#define PI_COMPILER_FLAGS "-O3 -march=native -flto"
+#endif
 
 // 理論上の円周率
 const double PI_THEORETICAL = 3.141592653589793238462643383279502884197;
 
-// シードの加算幅を大きくする（推奨方式）
-const uint64_t SEED_MULTIPLIER = 0x9E3779B97F4A7C15ULL;  // 黄金比の逆数（64ビット）
-
 /**
  * スレッドごとの計算用構造体
  */
 struct ThreadData {
     uint64_t iterations_per_thread;
-    int thread_id;
     uint64_t base_seed;
-    uint64_t inside_circle;
+    uint64_t first_sample;       // 逐次系列の中での担当区間の先頭
+    const EngineEntry *engine;   // 乱数エンジン（engine_registry.hpp）
+    const KernelConfig *config;  // 推定量・カーネルの種類と設定（全スレッドで共有）
+    Moments moments;             // 担当区間のサンプル値の和と二乗和
+    StreamingStats stats;        // 担当区間のチャンク単位の統計（estimators.hpp）
 };
 
 /**
  * スレッドごとの円周率計算
  * 
+ * エンジンはルート状態から first_sample 番目のサンプルの位置まで discard() してから始まる
+ * （浮動小数点版は1サンプル = 乱数2個、整数版はグループ単位、engine_registry.hpp）。
+ * discard() は O(log n) なので、スレッド数によらずシングルスレッド版と同一の系列を
+ * 重ならない連続区間に分割できる。
+ * 
  * @param data ThreadDataへのポインタ
  */
 void calculate_pi_thread(ThreadData *data) {
-    // 推奨方式: シードの加算幅を大きくする
-    uint64_t thread_seed = data->base_seed + (data->thread_id * SEED_MULTIPLIER);
-    Xoshiro256 rng(thread_seed);  // スレッドごとに独立したインスタンス
-    
-    uint64_t inside_circle = 0;
-    
-    for (uint64_t i = 0; i < data->iterations_per_thread; i++) {
-        // 0.0以上1.0未満の乱数を生成
-        double x = rng.next_double();
-        double y = rng.next_double();
-        
-        // 単位円内か判定（x^2 + y^2 <= 1）
-        if (x * x + y * y <= 1.0) {
-            inside_circle++;
-        }
-    }
-    
-    data->inside_circle = inside_circle;
+    data->moments = data->engine->estimate(
+        data->base_seed, data->first_sample, data->iterations_per_thread, *data->config, data->stats);
 }
 
 /**
@@ -54,25 +51,33 @@ void calculate_pi_thread(ThreadData *data) {
  * 
  * @param iterations 総試行回数
  * @param num_threads スレッド数
+ * @param engine 乱数エンジン
+ * @param config カーネルの種類と設定
  * @param pi_estimate 円周率の推定値（出力）
  * @param error 誤差（出力）
+ * @param moments サンプル値の和と二乗和（出力、estimators.hpp）
+ * @param stats チャンク単位の統計（出力、スレッドごとの統計を Chan の公式で合わせたもの）
  */
-void calculate_pi(uint64_t iterations, int num_threads, 
-                 double &pi_estimate, double &error) {
+void calculate_pi(uint64_t iterations, int num_threads, const EngineEntry &engine,
+                 const KernelConfig &config, double &pi_estimate, double &error, Moments &moments,
+                 StreamingStats &stats) {
     uint64_t iterations_per_thread = iterations / num_threads;
-    uint64_t base_seed = 12345;
+    uint64_t base_seed = config.seed;
     
     // スレッドとデータを準備
+    // スレッド i はサンプル i * iterations_per_thread から担当し、端数は最後のスレッドが受け持つ
     std::vector<std::thread> threads;
-    std::vector<ThreadData> thread_data(num_threads);
+    std::vector<ThreadData> thread_data;
+    thread_data.reserve(num_threads);
+    
+    for (int i = 0; i < num_threads; i++) {
+        uint64_t first = i * iterations_per_thread;
+        uint64_t count = (i == num_threads - 1) ? iterations - first : iterations_per_thread;
+        thread_data.push_back(ThreadData{count, base_seed, first, &engine, &config, Moments(), StreamingStats()});
+    }
     
     // スレッドを起動
     for (int i = 0; i < num_threads; i++) {
-        thread_data[i].iterations_per_thread = iterations_per_thread;
-        thread_data[i].thread_id = i;
-        thread_data[i].base_seed = base_seed;
-        thread_data[i].inside_circle = 0;
-        
         threads.emplace_back(calculate_pi_thread, &thread_data[i]);
     }
     
@@ -82,45 +87,220 @@ void calculate_pi(uint64_t iterations, int num_threads,
     }
     
     // 結果を集計
-    uint64_t total_inside = 0;
+    moments = Moments();
+    stats = StreamingStats();
     for (const auto &data : thread_data) {
-        total_inside += data.inside_circle;
+        moments.add(data.moments);
+        stats.merge(data.stats);
     }
     
-    // π ≈ 4 × (円内の点数) / (総試行回数)
-    pi_estimate = 4.0 * total_inside / iterations;
+    // π ≈ サンプル値の平均（当たり外れなら 4 × (円内の点数) / (総試行回数)、
+    // 整数版カーネルは格子の量子化バイアスを引く）
+    pi_estimate = moments.mean() - estimator_pi_bias(config);
     error = std::abs(pi_estimate - PI_THEORETICAL);
 }
 
-int main() {
-    const uint64_t iterations = 100000000ULL;
+// 停止を判定する前に必要なチャンク数（batch_std_error が出せる最小の数）
+constexpr uint64_t MIN_PRECISION_CHUNKS = 2;
+
+/**
+ * 目標精度モードで全スレッドが共有する状態（チャンクの割り当てと結果の集計）
+ * 
+ * チャンク（CHUNK_SAMPLES サンプル、engine_registry.hpp）の番号を共有カウンタから1つずつ渡し、
+ * 終わったチャンクの結果を共有の統計に合わせて（Chan の公式）、半幅 z × std_error が目標以下なら
+ * stop を立てる。他のスレッドは処理中のチャンクを終えてから止まるので、集計されるのは常に
+ * 先頭から連続したチャンクで、推定値は同じ試行回数の固定モードと同じ系列になる。
+ */
+class PrecisionState : public ChunkQueue {
+public:
+    uint64_t max_iterations = 0;     // 試行回数の上限
+    double target_half_width = 0.0;  // 信頼区間の半幅の目標
+    double z = 0.0;                  // 信頼水準の正規分布の両側点
+    Moments moments;                 // 終わったチャンクのサンプル値の和と二乗和
+    StreamingStats stats;            // 終わったチャンクの統計
+    bool converged = false;
+
+    bool claim(uint64_t &first_sample, uint64_t &n) override {
+        if (stop.load(std::memory_order_relaxed)) return false;
+        const uint64_t chunks = (max_iterations + CHUNK_SAMPLES - 1) / CHUNK_SAMPLES;
+        uint64_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= chunks) return false;
+        first_sample = chunk * CHUNK_SAMPLES;
+        n = std::min(CHUNK_SAMPLES, max_iterations - first_sample);
+        return true;
+    }
+
+    void publish(const Moments &chunk_moments, const StreamingStats &chunk_stats) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        moments.add(chunk_moments);
+        stats.merge(chunk_stats);
+        if (stats.batches >= MIN_PRECISION_CHUNKS && z * stats.std_error() <= target_half_width) {
+            converged = true;
+            stop.store(true, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<uint64_t> next_chunk{0};  // 次に割り当てるチャンクの番号
+    std::atomic<bool> stop{false};        // 目標に達したので新しいチャンクを渡さない
+    std::mutex mutex;                     // moments, stats, converged を守る
+};
+
+/**
+ * 目標精度モードのスレッド
+ * 
+ * エンジンはスレッドごとに1つで、取ったチャンクの間だけ discard する（estimate_chunks_with）
+ */
+void calculate_pi_precision_thread(const EngineEntry *engine, uint64_t base_seed, const KernelConfig *config,
+                                   PrecisionState *state) {
+    engine->estimate_chunks(base_seed, *config, *state);
+}
+
+/**
+ * 信頼区間の半幅が目標以下になるまで円周率を計算（目標精度モード、並列化版）
+ * 
+ * 試行回数を先に決めず、チャンク単位で進めながら統計を合わせ、目標に達したら全スレッドが
+ * 協調して止まる（PrecisionState）。止まるまでに処理中だったチャンクの分だけ
+ * 必要数より最大でスレッド数 × CHUNK_SAMPLES 多くなる。毎チャンク判定するので、
+ * 名目の信頼水準は固定の試行回数の区間より少し甘くなる。
+ * 
+ * @param options 目標の半幅（--precision）・信頼水準・試行回数の上限
+ * @param num_threads スレッド数
+ * @param engine 乱数エンジン
+ * @param config カーネルの種類と設定
+ * @param pi_estimate 円周率の推定値（出力）
+ * @param moments サンプル値の和と二乗和（出力、moments.n が使った試行回数）
+ * @param stats チャンク単位の統計（出力）
+ * @return 目標に達したか（false なら上限で打ち切り）
+ */
+bool calculate_pi_to_precision(const BenchOptions &options, int num_threads, const EngineEntry &engine,
+                               const KernelConfig &config, double &pi_estimate, Moments &moments,
+                               StreamingStats &stats) {
+    PrecisionState state;
+    state.max_iterations = options.max_iterations;
+    state.target_half_width = options.precision;
+    state.z = confidence_z(options.confidence);
+    
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+        threads.emplace_back(calculate_pi_precision_thread, &engine, config.seed, &config, &state);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    
+    moments = state.moments;
+    stats = state.stats;
+    pi_estimate = moments.mean() - estimator_pi_bias(config);
+    return state.converged;
+}
+
+int main(int argc, char *argv[]) {
     unsigned int num_threads = std::thread::hardware_concurrency();
     if (num_threads == 0) num_threads = 1;
     
-    // 実行時間の測定
-    std::clock_t start = std::clock();
-    double pi_estimate, error;
-    calculate_pi(iterations, num_threads, pi_estimate, error);
-    std::clock_t end = std::clock();
+    // --engine=NAME でエンジン、--kernel=NAME でカーネル、--estimator=NAME で推定量を選択（bench_options.hpp）
+    // （既定は他言語と同条件の Xoshiro256** + スカラー版）
+    BenchOptions options;
+    if (!parse_options(argc, argv, options)) return 1;
+    if (options.list_engines) {
+        print_engines();
+        return 0;
+    }
+    const EngineEntry &engine = *find_engine(options.engine.c_str());
+    Kernel kernel;
+    if (options.kernel == "simd") {
+        // 明示的SIMDカーネルはレーンごとに jump() したサブストリームで、逐次系列の区間に分けられない
+        std::cerr << "--kernel=simd is only available in pi_cpp_single\n";
+        return 1;
+    }
+    if (!parse_kernel(options.kernel, kernel)) {
+        std::cerr << "Unknown kernel: " << options.kernel << "\n";
+        return 1;
+    }
+    if (!check_kernel_engine(kernel, engine)) return 1;
+    std::unique_ptr<CellBitmap> bitmap;
+    KernelConfig config = make_kernel_config(kernel, options, bitmap);
+    if (!parse_estimator(options.estimator, config.estimator)) {
+        std::cerr << "Unknown estimator: " << options.estimator << "\n";
+        return 1;
+    }
+    if (!check_estimator_engine(config.estimator, engine)) return 1;
+    if (!check_precision_options(config, engine, options)) return 1;
+    uint64_t iterations = prepare_estimator(config, options);
+    const bool precision_mode = (options.precision > 0.0);
+    const bool compare_estimator = (config.estimator != Estimator::HitMiss);
+    
+    // 実行時間の測定（std::clock() は全スレッドのCPU時間の合計になるため、壁時計で測る）
+    // --scrambles=R ならシードを変えた R 本の複製を順に実行し、推定値の平均を取る
+    // --precision=H なら試行回数は区間の半幅が H 以下になった時点の数（moments.n）
+    auto start = std::chrono::steady_clock::now();
+    Moments moments;
+    StreamingStats stats;
+    std::vector<double> estimates;
+    bool converged = false;
+    if (precision_mode) {
+        double precision_pi;
+        converged = calculate_pi_to_precision(options, num_threads, engine, config, precision_pi, moments, stats);
+        iterations = moments.n;
+        estimates.push_back(precision_pi);
+    }
+    for (int r = 0; r < options.scrambles && !precision_mode; r++) {
+        KernelConfig replica_config = config;
+        replica_config.seed = config.seed + r;
+        double replica_pi, replica_error;
+        Moments replica_moments;
+        StreamingStats replica_stats;
+        calculate_pi(iterations, num_threads, engine, replica_config, replica_pi, replica_error, replica_moments,
+                     replica_stats);
+        moments.add(replica_moments);
+        stats.merge(replica_stats);
+        estimates.push_back(replica_pi);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double pi_estimate = replica_mean(estimates);
+    double error = std::abs(pi_estimate - PI_THEORETICAL);
+    
+    double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
     
-    double elapsed_ms = ((double)(end - start) / CLOCKS_PER_SEC) * 1000.0;
+    // 推定量の比較用に、同じ試行回数の当たり外れ（--kernel のカーネル）も測る
+    Moments baseline;
+    double baseline_ms = 0.0;
+    if (compare_estimator) {
+        KernelConfig baseline_config = config;
+        baseline_config.estimator = Estimator::HitMiss;
+        double baseline_pi, baseline_error;
+        StreamingStats baseline_stats;
+        auto baseline_start = std::chrono::steady_clock::now();
+        calculate_pi(iterations, num_threads, engine, baseline_config, baseline_pi, baseline_error, baseline,
+                     baseline_stats);
+        baseline_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - baseline_start).count();
+    }
     
     // 結果をJSON形式で出力
     std::cout << std::fixed << std::setprecision(15);
     std::cout << "{\n";
     std::cout << "  \"language\": \"C++\",\n";
-    std::cout << "  \"variant\": \"standard\",\n";
+    std::cout << "  \"variant\": \"" << kernel_variant(kernel) << "\",\n";
+    std::cout << "  \"engine\": \"" << engine.name << "\",\n";
+    print_kernel_config_json(config);
     std::cout << "  \"version\": \"C++17\",\n";
     std::cout << "  \"mode\": \"parallel\",\n";
     std::cout << "  \"iterations\": " << iterations << ",\n";
     std::cout << "  \"pi_estimate\": " << pi_estimate << ",\n";
     std::cout << "  \"error\": " << error << ",\n";
+    print_estimator_json(config, moments, elapsed_ms, compare_estimator ? &baseline : nullptr, baseline_ms,
+                         options.target_error);
+    print_interval_json(pi_estimate, stats, estimates, engine);
+    if (precision_mode) print_precision_json(options, stats, converged);
+    print_replica_json(estimates, moments);
     std::cout << std::setprecision(2);
     std::cout << "  \"time_ms\": " << elapsed_ms << ",\n";
+    std::cout << "  \"samples_per_sec\": " << iterations * options.scrambles / (elapsed_ms / 1000.0) << ",\n";
     std::cout << "  \"memory_mb\": 0.0,\n";  // runner.pyで測定
     std::cout << "  \"cache_misses\": 0,\n";  // runner.pyで測定
     std::cout << "  \"lines_of_code\": 0,\n";  // runner.pyで計算
-    std::cout << "  \"compiler_flags\": \"-O3 -march=native -flto\",\n";
+    std::cout << "  \"compiler_flags\": \"" << PI_COMPILER_FLAGS << "\",\n";
     std::cout << "  \"cpu_model\": \"N/A\",\n";
     std::cout << "  \"cpu_cores\": " << num_threads << ",\n";
     std::cout << "  \"thread_count\": " << num_threads << ",\n";
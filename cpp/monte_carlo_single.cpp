@@ -2,7 +2,16 @@
 #include <iomanip>
 #include <cmath>
 #include <ctime>
+#include <vector>
 #include "xoshiro256.hpp"
+#include "xoshiro256_simd.hpp"
+#include "engine_registry.hpp"
+#include "bench_options.hpp"
+
+// JSONに記録するコンパイラフラグ（LTOなしビルドでは Makefile から上書き）
+#ifndef PI_COMPILER_FLAGS
+#define PI_COMPILER_FLAGS "-O3 -march=native -flto"
+#endif
 
 // 理論上の円周率
 const double PI_THEORETICAL = 3.141592653589793238462643383279502884197;
@@ -11,65 +20,245 @@ const double PI_THEORETICAL = 3.141592653589793238462643383279502884197;
  * モンテカルロ法で円周率を計算
  * 
  * @param iterations 試行回数
+ * @param engine 乱数エンジン（engine_registry.hpp のエントリ）
+ * @param config カーネルの種類と設定
+ * @param pi_estimate 円周率の推定値（出力）
+ * @param error 誤差（出力）
+ * @param moments サンプル値の和と二乗和（出力、estimators.hpp）
+ * @param stats チャンク単位の統計（足し込む、estimators.hpp）
+ */
+void calculate_pi(uint64_t iterations, const EngineEntry &engine, const KernelConfig &config,
+                 double &pi_estimate, double &error, Moments &moments, StreamingStats &stats) {
+    // 固定シード（config.seed）の系列の先頭から iterations サンプルを判定
+    moments = engine.estimate(config.seed, 0, iterations, config, stats);
+    
+    // π ≈ サンプル値の平均（当たり外れなら 4 × (円内の点数) / (総試行回数)、
+    // 整数版カーネルは格子の量子化バイアスを引く）
+    pi_estimate = moments.mean() - estimator_pi_bias(config);
+    error = std::abs(pi_estimate - PI_THEORETICAL);
+}
+
+#if defined(PI_SIMD_DISPATCH)
+/**
+ * モンテカルロ法で円周率を計算（AVX2版、1反復で4点を判定）
+ * 
+ * target 属性で AVX2 向けにコンパイルするので、呼び出し側が __builtin_cpu_supports() で確かめる
+ * 
+ * @param iterations 試行回数
+ * @param seed シード（ルート状態、KernelConfig::seed）
  * @param pi_estimate 円周率の推定値（出力）
  * @param error 誤差（出力）
+ * @param moments サンプル値の和と二乗和（出力）
  */
-void calculate_pi(uint64_t iterations, double &pi_estimate, double &error) {
-    Xoshiro256 rng(12345);  // 固定シード
+PI_TARGET_AVX2 void calculate_pi_avx2(uint64_t iterations, uint64_t seed, double &pi_estimate, double &error,
+                                      Moments &moments) {
+    Xoshiro256x4 rng{Xoshiro256(seed)};  // シードのルートから4サブストリーム
+    const __m256d one = _mm256_set1_pd(1.0);
     
     uint64_t inside_circle = 0;
+    uint64_t i = 0;
     
-    for (uint64_t i = 0; i < iterations; i++) {
-        // 0.0以上1.0未満の乱数を生成
-        double x = rng.next_double();
-        double y = rng.next_double();
+    for (; i + 4 <= iterations; i += 4) {
+        __m256d x = rng.next_double();
+        __m256d y = rng.next_double();
         
-        // 単位円内か判定（x^2 + y^2 <= 1）
-        if (x * x + y * y <= 1.0) {
-            inside_circle++;
-        }
+        // 4点まとめて比較し、マスクのビット数を数える
+        __m256d d = _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y));
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(d, one, _CMP_LE_OQ));
+        inside_circle += __builtin_popcount(mask);
+    }
+    
+    // 端数（4未満）は余分なレーンをマスクで落とす
+    if (i < iterations) {
+        __m256d x = rng.next_double();
+        __m256d y = rng.next_double();
+        __m256d d = _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y));
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(d, one, _CMP_LE_OQ));
+        inside_circle += __builtin_popcount(mask & ((1 << (iterations - i)) - 1));
+    }
+    
+    moments = hit_miss_moments(inside_circle, iterations);
+    pi_estimate = 4.0 * inside_circle / iterations;
+    error = std::abs(pi_estimate - PI_THEORETICAL);
+}
+
+/**
+ * モンテカルロ法で円周率を計算（AVX-512版、1反復で8点を判定）
+ * 
+ * target 属性で AVX-512F/DQ 向けにコンパイルするので、呼び出し側が __builtin_cpu_supports() で確かめる
+ * 
+ * @param iterations 試行回数
+ * @param seed シード（ルート状態、KernelConfig::seed）
+ * @param pi_estimate 円周率の推定値（出力）
+ * @param error 誤差（出力）
+ * @param moments サンプル値の和と二乗和（出力）
+ */
+PI_TARGET_AVX512 void calculate_pi_avx512(uint64_t iterations, uint64_t seed, double &pi_estimate, double &error,
+                                          Moments &moments) {
+    Xoshiro256x8 rng{Xoshiro256(seed)};  // シードのルートから8サブストリーム
+    const __m512d one = _mm512_set1_pd(1.0);
+    
+    uint64_t inside_circle = 0;
+    uint64_t i = 0;
+    
+    for (; i + 8 <= iterations; i += 8) {
+        __m512d x = rng.next_double();
+        __m512d y = rng.next_double();
+        
+        // 比較結果をマスクレジスタで受け取り、そのままpopcount
+        __m512d d = _mm512_add_pd(_mm512_mul_pd(x, x), _mm512_mul_pd(y, y));
+        __mmask8 mask = _mm512_cmp_pd_mask(d, one, _CMP_LE_OQ);
+        inside_circle += __builtin_popcount(mask);
+    }
+    
+    // 端数（8未満）は有効レーンだけを比較する
+    if (i < iterations) {
+        __mmask8 valid = (__mmask8)((1u << (iterations - i)) - 1);
+        __m512d x = rng.next_double();
+        __m512d y = rng.next_double();
+        __m512d d = _mm512_add_pd(_mm512_mul_pd(x, x), _mm512_mul_pd(y, y));
+        __mmask8 mask = _mm512_mask_cmp_pd_mask(valid, d, one, _CMP_LE_OQ);
+        inside_circle += __builtin_popcount(mask);
     }
     
-    // π ≈ 4 × (円内の点数) / (総試行回数)
+    moments = hit_miss_moments(inside_circle, iterations);
     pi_estimate = 4.0 * inside_circle / iterations;
     error = std::abs(pi_estimate - PI_THEORETICAL);
 }
+#endif
 
-int main() {
-    const uint64_t iterations = 100000000ULL;
+int main(int argc, char *argv[]) {
+    // --engine=NAME でエンジン、--kernel=NAME でカーネル、--estimator=NAME で推定量を選択（bench_options.hpp）
+    // （既定は他言語と同条件の Xoshiro256** + スカラー版）
+    BenchOptions options;
+    if (!parse_options(argc, argv, options)) return 1;
+    if (options.list_engines) {
+        print_engines();
+        return 0;
+    }
+    const EngineEntry &engine = *find_engine(options.engine.c_str());
+    
+    Kernel kernel = Kernel::Scalar;
+    bool use_simd = (options.kernel == "simd");
+    if (use_simd && options.engine != "xoshiro256ss") {
+        std::cerr << "--kernel=simd is only available with --engine=xoshiro256ss\n";
+        return 1;
+    }
+    if (!use_simd && !parse_kernel(options.kernel, kernel)) {
+        std::cerr << "Unknown kernel: " << options.kernel << "\n";
+        return 1;
+    }
+    if (!check_kernel_engine(kernel, engine)) return 1;
+    std::unique_ptr<CellBitmap> bitmap;
+    KernelConfig config = make_kernel_config(kernel, options, bitmap);
+    if (!parse_estimator(options.estimator, config.estimator)) {
+        std::cerr << "Unknown estimator: " << options.estimator << "\n";
+        return 1;
+    }
+    if (!check_estimator_engine(config.estimator, engine)) return 1;
+    const uint64_t iterations = prepare_estimator(config, options);
+    const bool compare_estimator = (config.estimator != Estimator::HitMiss);
+    if (use_simd && compare_estimator) {
+        std::cerr << "--kernel=simd is only available with --estimator=hitmiss\n";
+        return 1;
+    }
+    if (options.precision > 0.0) {
+        std::cerr << "--precision is only available in pi_cpp_parallel\n";
+        return 1;
+    }
+    
+    // SIMD版は実行中の CPU が対応している最も広いSIMD幅を選ぶ（AVX-512 → AVX2 → スカラー）
+    void (*simd_kernel)(uint64_t, uint64_t, double &, double &, Moments &) = nullptr;
+    const char *variant = kernel_variant(kernel);
+    const char *simd_name = nullptr;
+#if defined(PI_SIMD_DISPATCH)
+    if (use_simd) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+            simd_kernel = calculate_pi_avx512;
+            variant = "avx512";
+            simd_name = "AVX-512";
+        } else if (__builtin_cpu_supports("avx2")) {
+            simd_kernel = calculate_pi_avx2;
+            variant = "avx2";
+            simd_name = "AVX2";
+        }
+    }
+#endif
     
     // 実行時間の測定
+    // --scrambles=R ならシードを変えた R 本の複製を順に実行し、推定値の平均を取る
     std::clock_t start = std::clock();
-    double pi_estimate, error;
-    calculate_pi(iterations, pi_estimate, error);
+    Moments moments;
+    StreamingStats stats;
+    std::vector<double> estimates;
+    for (int r = 0; r < options.scrambles; r++) {
+        double replica_pi, replica_error;
+        Moments replica_moments;
+        KernelConfig replica_config = config;
+        replica_config.seed = config.seed + r;
+        if (simd_kernel) {
+            // SIMD版は全体を1チャンクとして集計する
+            simd_kernel(iterations, replica_config.seed, replica_pi, replica_error, replica_moments);
+            stats.add_chunk(replica_moments);
+        } else {
+            calculate_pi(iterations, engine, replica_config, replica_pi, replica_error, replica_moments, stats);
+        }
+        moments.add(replica_moments);
+        estimates.push_back(replica_pi);
+    }
     std::clock_t end = std::clock();
+    double pi_estimate = replica_mean(estimates);
+    double error = std::abs(pi_estimate - PI_THEORETICAL);
     
     double elapsed_ms = ((double)(end - start) / CLOCKS_PER_SEC) * 1000.0;
     
+    // 推定量の比較用に、同じ試行回数の当たり外れ（--kernel のカーネル）も測る
+    Moments baseline;
+    double baseline_ms = 0.0;
+    if (compare_estimator) {
+        KernelConfig baseline_config = config;
+        baseline_config.estimator = Estimator::HitMiss;
+        double baseline_pi, baseline_error;
+        StreamingStats baseline_stats;
+        std::clock_t baseline_start = std::clock();
+        calculate_pi(iterations, engine, baseline_config, baseline_pi, baseline_error, baseline, baseline_stats);
+        baseline_ms = ((double)(std::clock() - baseline_start) / CLOCKS_PER_SEC) * 1000.0;
+    }
+    
     // 結果をJSON形式で出力
     std::cout << std::fixed << std::setprecision(15);
     std::cout << "{\n";
     std::cout << "  \"language\": \"C++\",\n";
-    std::cout << "  \"variant\": \"standard\",\n";
+    std::cout << "  \"variant\": \"" << variant << "\",\n";
+    std::cout << "  \"engine\": \"" << engine.name << "\",\n";
+    print_kernel_config_json(config);
     std::cout << "  \"version\": \"C++17\",\n";
     std::cout << "  \"mode\": \"single\",\n";
     std::cout << "  \"iterations\": " << iterations << ",\n";
     std::cout << "  \"pi_estimate\": " << pi_estimate << ",\n";
     std::cout << "  \"error\": " << error << ",\n";
+    print_estimator_json(config, moments, elapsed_ms, compare_estimator ? &baseline : nullptr, baseline_ms,
+                         options.target_error);
+    print_interval_json(pi_estimate, stats, estimates, engine);
+    print_replica_json(estimates, moments);
     std::cout << std::setprecision(2);
     std::cout << "  \"time_ms\": " << elapsed_ms << ",\n";
+    std::cout << "  \"samples_per_sec\": " << iterations * options.scrambles / (elapsed_ms / 1000.0) << ",\n";
     std::cout << "  \"memory_mb\": 0.0,\n";  // runner.pyで測定
     std::cout << "  \"cache_misses\": 0,\n";  // runner.pyで測定
     std::cout << "  \"lines_of_code\": 0,\n";  // runner.pyで計算
-    std::cout << "  \"compiler_flags\": \"-O3 -march=native -flto\",\n";
+    std::cout << "  \"compiler_flags\": \"" << PI_COMPILER_FLAGS << "\",\n";
     std::cout << "  \"cpu_model\": \"N/A\",\n";
     std::cout << "  \"cpu_cores\": 1,\n";
     std::cout << "  \"thread_count\": 1,\n";
     std::cout << "  \"os\": \"N/A\",\n";
     std::cout << "  \"os_version\": \"N/A\",\n";
     std::cout << "  \"compiler\": \"GCC/Clang\",\n";
-    std::cout << "  \"simd_detected\": false,\n";
-    std::cout << "  \"simd_instructions\": []\n";
+    std::cout << "  \"simd_detected\": " << (simd_name ? "true" : "false") << ",\n";
+    std::cout << "  \"simd_instructions\": [";
+    if (simd_name) std::cout << "\"" << simd_name << "\"";
+    std::cout << "]\n";
     std::cout << "}\n";
     
     return 0;
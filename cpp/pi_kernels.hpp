@@ -0,0 +1,683 @@
+#ifndef PI_KERNELS_HPP
+#define PI_KERNELS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <array>
+#include <utility>
+#include "xoshiro256.hpp"
+#include "cell_bitmap.hpp"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+/**
+ * シングルスレッド版・並列版で共有する円内判定カーネル
+ * 
+ * どのカーネルも乱数エンジンの型をテンプレート引数に取る
+ * （エンジンの要件は engines.hpp を参照）。1サンプルは next_double() 2回分。
+ */
+
+// ブロック版カーネルのバッファ長（倍精度 2048 個 = 16KB、L1データキャッシュに収まる）
+const size_t BLOCK_DOUBLES = 2048;
+
+// 整数版カーネルのバッファ長（64ビット整数 2048 個 = 16KB）
+const size_t BLOCK_WORDS = 2048;
+
+/**
+ * スカラー版カーネル: 1サンプルずつ生成して判定
+ * 
+ * @param rng 乱数生成器（n サンプル分進む）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <class Engine>
+inline uint64_t count_inside(Engine &rng, uint64_t n) {
+    uint64_t inside_circle = 0;
+    
+    for (uint64_t i = 0; i < n; i++) {
+        // 0.0以上1.0未満の乱数を生成
+        double x = rng.next_double();
+        double y = rng.next_double();
+        
+        // 単位円内か判定（x^2 + y^2 <= 1）
+        if (x * x + y * y <= 1.0) {
+            inside_circle++;
+        }
+    }
+    
+    return inside_circle;
+}
+
+/**
+ * ブロック版カーネル: 乱数生成と円内判定を別パスに分ける
+ * 
+ * 1. fill_double() で L1 サイズのバッファに x, y を交互に生成
+ * 2. バッファを走査して x^2 + y^2 <= 1 を数える（分岐なしでベクトル化される）
+ * 
+ * next_double() を2回ずつ呼ぶスカラー版と同じ系列・同じ判定なので、結果も一致する。
+ * 生成と判定が別ループなので、プロファイラで両者のコストを分けて見られる。
+ * 
+ * @param rng 乱数生成器（n サンプル分進む）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <class Engine>
+inline uint64_t count_inside_block(Engine &rng, uint64_t n) {
+    alignas(64) double buffer[BLOCK_DOUBLES];
+    uint64_t inside_circle = 0;
+    
+    while (n > 0) {
+        size_t samples = (n < BLOCK_DOUBLES / 2) ? (size_t)n : BLOCK_DOUBLES / 2;
+        rng.fill_double(buffer, 2 * samples);
+        
+        uint64_t block_inside = 0;
+        for (size_t i = 0; i < samples; i++) {
+            double x = buffer[2 * i];
+            double y = buffer[2 * i + 1];
+            block_inside += (x * x + y * y <= 1.0);
+        }
+        inside_circle += block_inside;
+        n -= samples;
+    }
+    
+    return inside_circle;
+}
+
+/**
+ * 同じ状態のコピーを K 個並べる（エンジンはデフォルト構築できないので配列の初期化子で作る）
+ */
+template <class Engine, size_t... I>
+inline std::array<Engine, sizeof...(I)> replicate_engine(const Engine &rng, std::index_sequence<I...>) {
+    return {{((void)I, rng)...}};
+}
+
+/**
+ * 多系列インターリーブ版カーネル: K 個の状態を交互に進めて依存チェーンを断つ
+ *
+ * スカラー版は1つの状態の更新（Xoshiro256 なら約4命令の直列チェーン）を待ってから
+ * 次の乱数を作るので、SIMDなしでもレイテンシ律速になる。n サンプルを K 本の区間に分け、
+ * 区間の先頭まで discard()（ジャンプ多項式）で飛ばした K 個の状態を1サンプルずつ
+ * 交互に進めると、互いに独立な K 本のチェーンをアウトオブオーダー実行が重ねられる。
+ * AVX を使わないビルドでも効く移植性のある ILP 最適化。
+ *
+ * 区間は系列上で連続に並べるので、数える点の集合はスカラー版と同じで点数も一致する
+ * （並列版の discard による分割とも両立する）。区間に分けきれない端数は最後の状態で処理する。
+ * 状態は K × 32 バイト（Xoshiro256）なので、K = 8 ではレジスタに載り切らない。
+ *
+ * @param rng 乱数生成器（n サンプル分進む）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <int K, class Engine>
+inline uint64_t count_inside_interleaved(Engine &rng, uint64_t n) {
+    static_assert(K >= 1, "K must be positive");
+    const uint64_t lane_samples = n / K;
+
+    std::array<Engine, K> lanes = replicate_engine(rng, std::make_index_sequence<K>());
+    for (int k = 1; k < K; k++) {
+        lanes[k] = lanes[k - 1];
+        lanes[k].discard(2 * lane_samples);
+    }
+
+    // 点数は反復ごとに K 区間分を足してから合計に加える（区間ごとの配列に数えると、GCC 12 の
+    // AVX2/AVX-512 ビルドで状態が加算だけの SplitMix64 の K = 8 が半分のレーンの結果を2回数える誤ったコードになる）
+    uint64_t inside_circle = 0;
+    for (uint64_t i = 0; i < lane_samples; i++) {
+        uint64_t hits = 0;
+        for (int k = 0; k < K; k++) {
+            double x = lanes[k].next_double();
+            double y = lanes[k].next_double();
+            hits += (x * x + y * y <= 1.0);
+        }
+        inside_circle += hits;
+    }
+
+    // 端数は最後の区間の続き（系列上の位置 K * lane_samples から）
+    rng = lanes[K - 1];
+    inside_circle += count_inside(rng, n - K * lane_samples);
+
+    return inside_circle;
+}
+
+/**
+ * 数え方を固定したスカラー版カーネル
+ *
+ * count_inside() の if (x * x + y * y <= 1.0) inside_circle++; は分岐にするか
+ * setcc / cmov にするかがコンパイラ任せで、円内の確率 π/4 ≈ 78.5% の分岐は
+ * 予測が外れやすい（約21.5%のサンプルで外れる）。以下の3つは生成・系列は
+ * count_inside() と同じで、数え方だけをコンパイラのバージョンに依存しない形に固定する
+ * （点数はすべて一致する）。
+ */
+
+/**
+ * 分岐版: 円内のときだけ実行される空の asm volatile を置き、if 変換を抑止する
+ *
+ * @param rng 乱数生成器（n サンプル分進む）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <class Engine>
+inline uint64_t count_inside_branchy(Engine &rng, uint64_t n) {
+    uint64_t inside_circle = 0;
+
+    for (uint64_t i = 0; i < n; i++) {
+        double x = rng.next_double();
+        double y = rng.next_double();
+        if (x * x + y * y <= 1.0) {
+            asm volatile("");
+            inside_circle++;
+        }
+    }
+
+    return inside_circle;
+}
+
+/**
+ * 分岐なし版: 比較結果（0 / 1）をそのまま足す（setcc + add）
+ *
+ * @param rng 乱数生成器（n サンプル分進む）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <class Engine>
+inline uint64_t count_inside_branchless(Engine &rng, uint64_t n) {
+    uint64_t inside_circle = 0;
+
+    for (uint64_t i = 0; i < n; i++) {
+        double x = rng.next_double();
+        double y = rng.next_double();
+        inside_circle += (x * x + y * y <= 1.0);
+    }
+
+    return inside_circle;
+}
+
+/**
+ * マスク版: 64サンプル分の比較結果をビットマスクに詰め、popcount で数える
+ *
+ * 加算の依存チェーンが64サンプルに1回になり、比較結果は独立なシフト・OR で集まる。
+ * 64の倍数に満たない端数は分岐なし版で数える。
+ *
+ * @param rng 乱数生成器（n サンプル分進む）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <class Engine>
+inline uint64_t count_inside_popcount(Engine &rng, uint64_t n) {
+    uint64_t inside_circle = 0;
+
+    for (; n >= 64; n -= 64) {
+        uint64_t mask = 0;
+        for (int bit = 0; bit < 64; bit++) {
+            double x = rng.next_double();
+            double y = rng.next_double();
+            mask |= (uint64_t)(x * x + y * y <= 1.0) << bit;
+        }
+        inside_circle += (uint64_t)__builtin_popcountll(mask);
+    }
+
+    return inside_circle + count_inside_branchless(rng, n);
+}
+
+/**
+ * 上位ビットによる早期判定の閾値表
+ * 
+ * x, y の上位 PREFIX_BITS ビット i, j（M = 2^PREFIX_BITS）で、点はセル
+ * [i/M, (i+1)/M) × [j/M, (j+1)/M) に入る。
+ * - 遠い角が円内 ((i+1)^2 + (j+1)^2 < M^2) なら、セル内のどの点も円内
+ * - 近い角が円外 (i^2 + j^2 > M^2) なら、セル内のどの点も円外
+ * - それ以外（円周が通る境界セル、全体の約 π/M）だけ倍精度で判定する
+ * 
+ * どちらの不等式も整数なので、1との差は 1/M^2 ≥ 2^-24 以上あり、
+ * 倍精度の x*x + y*y の丸め誤差（2^-52 程度）で判定が変わることはない。
+ * よって結果は x*x + y*y <= 1.0 をすべての点で計算した場合と一致する。
+ * 
+ * i ごとに閾値を持つ（j < inside[i] なら円内、j >= outside[i] なら円外）。
+ */
+template <int PREFIX_BITS>
+struct PrefixTable {
+    uint16_t inside[1 << PREFIX_BITS];
+    uint16_t outside[1 << PREFIX_BITS];
+};
+
+template <int PREFIX_BITS>
+constexpr PrefixTable<PREFIX_BITS> make_prefix_table() {
+    constexpr uint64_t m = 1ULL << PREFIX_BITS;
+    PrefixTable<PREFIX_BITS> table = {};
+    uint64_t in = m, out = m;  // i が増えると閾値は単調に減る
+    for (uint64_t i = 0; i < m; i++) {
+        while (in > 0 && (i + 1) * (i + 1) + in * in >= m * m) in--;  // j = in - 1 の遠い角
+        while (out > 0 && i * i + (out - 1) * (out - 1) > m * m) out--;
+        table.inside[i] = (uint16_t)in;
+        table.outside[i] = (uint16_t)out;
+    }
+    return table;
+}
+
+template <int PREFIX_BITS>
+inline constexpr PrefixTable<PREFIX_BITS> PREFIX_TABLE = make_prefix_table<PREFIX_BITS>();
+
+/**
+ * 閾値表がセルの角の判定と一致するか（全セルを調べる、コンパイル時の検証用）
+ */
+template <int PREFIX_BITS>
+constexpr bool prefix_table_matches_cells() {
+    constexpr uint64_t m = 1ULL << PREFIX_BITS;
+    const PrefixTable<PREFIX_BITS> table = make_prefix_table<PREFIX_BITS>();
+    for (uint64_t i = 0; i < m; i++) {
+        for (uint64_t j = 0; j < m; j++) {
+            bool inside = (i + 1) * (i + 1) + (j + 1) * (j + 1) < m * m;
+            bool outside = i * i + j * j > m * m;
+            if (inside != (j < table.inside[i]) || outside != (j >= table.outside[i])) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(prefix_table_matches_cells<8>(), "8-bit prefix table");
+
+/**
+ * 早期判定カーネル: 上位ビットの閾値表で大半の点を判定し、境界セルだけ倍精度で判定
+ * 
+ * 乱数は fill() で整数のまま受け取り、上位 PREFIX_BITS ビットのシフトと表引き・比較だけで
+ * 円内・円外を決める。境界セルの点（8ビットで約1.2%、12ビットで約0.08%）は
+ * 1パス目で番号だけを分岐なしで詰めておき、2パス目でまとめて next_double() と同じ値に
+ * 変換して x*x + y*y <= 1.0 を計算する（境界判定を分岐にすると予測ミスが目立つ）。
+ * 同じ系列なら count_inside() / count_inside_block() と同じ点数になる。
+ * 
+ * 表は 2^PREFIX_BITS × 4 バイト（8ビットで1KB、12ビットで16KB、L1に収まる）。
+ * 
+ * @param rng 乱数生成器（n サンプル分進む）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <int PREFIX_BITS, class Engine>
+inline uint64_t count_inside_early_out(Engine &rng, uint64_t n) {
+    constexpr int SHIFT = 64 - PREFIX_BITS;
+    const PrefixTable<PREFIX_BITS> &table = PREFIX_TABLE<PREFIX_BITS>;
+    alignas(64) uint64_t buffer[BLOCK_WORDS];
+    uint32_t boundary[BLOCK_WORDS / 2];  // 境界セルに入ったサンプルの番号
+    uint64_t inside_circle = 0;
+    
+    while (n > 0) {
+        size_t samples = (n < BLOCK_WORDS / 2) ? (size_t)n : BLOCK_WORDS / 2;
+        rng.fill(buffer, 2 * samples);
+        
+        // 1パス目: 表で判定し、境界セルのサンプル番号を詰める
+        uint64_t block_inside = 0;
+        size_t boundary_count = 0;
+        for (size_t s = 0; s < samples; s++) {
+            uint32_t i = (uint32_t)(buffer[2 * s] >> SHIFT);
+            uint32_t j = (uint32_t)(buffer[2 * s + 1] >> SHIFT);
+            uint32_t lo = table.inside[i];
+            uint32_t hi = table.outside[i];
+            block_inside += (j < lo);
+            // lo <= j < hi（境界セル）を符号なしの差で1回の比較にする
+            boundary[boundary_count] = (uint32_t)s;
+            boundary_count += (j - lo < hi - lo);
+        }
+        
+        // 2パス目: 境界セルの点だけ倍精度で判定
+        for (size_t k = 0; k < boundary_count; k++) {
+            double x = u64_to_double(buffer[2 * boundary[k]]);
+            double y = u64_to_double(buffer[2 * boundary[k] + 1]);
+            block_inside += (x * x + y * y <= 1.0);
+        }
+        inside_circle += block_inside;
+        n -= samples;
+    }
+    
+    return inside_circle;
+}
+
+/**
+ * ビットマップ版カーネル: セル分類ビットマップを引き、境界セルだけ倍精度で判定
+ * 
+ * 早期判定カーネルと同じ2パス構成で、行ごとの閾値表の代わりに
+ * 2^BITS × 2^BITS セルの表（cell_bitmap.hpp）を引く。表の大きさを L1 から DRAM まで
+ * 変えられるので、同じ推定値のままメモリ律速の負荷になる（キャッシュミス・帯域の測定用）。
+ * 同じ系列なら count_inside() / count_inside_block() と同じ点数になる。
+ * 
+ * @param rng 乱数生成器（n サンプル分進む）
+ * @param bitmap セル分類の表（読み取り専用、スレッド間で共有できる）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <class Engine>
+inline uint64_t count_inside_bitmap(Engine &rng, const CellBitmap &bitmap, uint64_t n) {
+    const int shift = 64 - bitmap.bits();
+    alignas(64) uint64_t buffer[BLOCK_WORDS];
+    uint32_t boundary[BLOCK_WORDS / 2];  // 境界セルに入ったサンプルの番号
+    uint64_t inside_circle = 0;
+    
+    while (n > 0) {
+        size_t samples = (n < BLOCK_WORDS / 2) ? (size_t)n : BLOCK_WORDS / 2;
+        rng.fill(buffer, 2 * samples);
+        
+        // 1パス目: 表で判定し、境界セルのサンプル番号を詰める
+        uint64_t block_inside = 0;
+        size_t boundary_count = 0;
+        for (size_t s = 0; s < samples; s++) {
+            uint64_t cell = bitmap.cell(buffer[2 * s] >> shift, buffer[2 * s + 1] >> shift);
+            block_inside += cell & CellBitmap::INSIDE;
+            boundary[boundary_count] = (uint32_t)s;
+            boundary_count += cell >> 1;  // BOUNDARY のときだけ1
+        }
+        
+        // 2パス目: 境界セルの点だけ倍精度で判定
+        for (size_t k = 0; k < boundary_count; k++) {
+            double x = u64_to_double(buffer[2 * boundary[k]]);
+            double y = u64_to_double(buffer[2 * boundary[k] + 1]);
+            block_inside += (x * x + y * y <= 1.0);
+        }
+        inside_circle += block_inside;
+        n -= samples;
+    }
+    
+    return inside_circle;
+}
+
+/**
+ * 整数版（ビットパック）カーネルの精度段階
+ * 
+ * 座標を BITS ビットの整数 i ∈ [0, 2^BITS) とし、64ビット乱数1個から
+ * floor(64 / BITS) 個の座標を下位ビットから順に切り出す。サンプル s は座標 2s, 2s+1。
+ * 
+ *   BITS   座標/乱数   サンプル/乱数   グループ（乱数 → サンプル）
+ *    32        2           1            1 → 1
+ *    26        2           1            1 → 1
+ *    21        3          1.5           2 → 3
+ *    16        4           2            1 → 2
+ * 
+ * 座標が奇数個の段階は乱数2個を1グループとし、グループ単位で判定する。
+ * 
+ * 格子の量子化バイアスと補正:
+ * - 判定は格子 {0, 1/N, ..., (N-1)/N}^2（N = 2^BITS）の左下隅で行うので、
+ *   1サンプルが円内に入る確率は π/4 ではなく正確に C / N^2
+ *   （C = #{(i, j) ∈ [0, N)^2 : i^2 + j^2 < N^2} = Σ_i (isqrt(N^2 - 1 - i^2) + 1)）
+ * - よって 4 × (円内の点数) / n の期待値は π + PI_BIAS（PI_BIAS = 4C / N^2 - π）で、
+ *   PI_BIAS を引けば不偏になる。PI_BIAS は正で 4/N を超えない（軸上の格子点の分）
+ * - C は整数の数え上げ（count_lattice_points()）で求めた定数。16ビットはコンパイル時に、
+ *   それ以外は make check-cpp で数え直して検証する。PI_BIAS は 32, 26, 21, 16 ビットで約 9.3e-10, 6.0e-8, 1.9e-6, 6.1e-5
+ */
+template <int BITS>
+struct PackedTier {
+    static constexpr int COORDS_PER_DRAW = 64 / BITS;
+    static constexpr int DRAWS_PER_GROUP = (COORDS_PER_DRAW % 2 == 0) ? 1 : 2;
+    static constexpr int SAMPLES_PER_GROUP = COORDS_PER_DRAW * DRAWS_PER_GROUP / 2;
+    static constexpr uint64_t MASK = (BITS == 64) ? ~0ULL : (1ULL << BITS) - 1;
+};
+
+/**
+ * 格子点の数 C（BITS ビット格子で四分円内に入る左下隅の数）
+ */
+constexpr uint64_t lattice_count(int bits) {
+    switch (bits) {
+    case 16: return 3373324577ULL;
+    case 21: return 3454219747773ULL;
+    case 26: return 3537118943117027ULL;
+    case 32: return 14488038920449089330ULL;
+    default: return 0;
+    }
+}
+
+/**
+ * 量子化バイアス PI_BIAS = 4C / N^2 - π（推定値から引くと不偏になる）
+ */
+constexpr double packed_pi_bias(int bits) {
+    const long double pi = 3.141592653589793238462643383279502884L;
+    long double n2 = 1.0L;
+    for (int i = 0; i < 2 * bits; i++) n2 *= 2.0L;
+    return (double)(4.0L * (long double)lattice_count(bits) / n2 - pi);
+}
+
+/**
+ * 格子点の数え上げ（lattice_count() の検証用、O(N)）
+ *
+ * 32ビットでは N^2 = 2^64 になるので、二乗和は128ビット整数で比べる。
+ * 16ビットはコンパイル時に、それ以外は make check-cpp（self_check.cpp）が実行時に数える
+ */
+constexpr uint64_t count_lattice_points(int bits) {
+    using u128 = unsigned __int128;
+    const uint64_t n = 1ULL << bits;
+    const u128 n2 = (u128)n * n;
+    uint64_t count = 0;
+    uint64_t j = n;  // i が増えると境界の j は単調に減る
+    for (uint64_t i = 0; i < n; i++) {
+        while (j > 0 && (u128)i * i + (u128)(j - 1) * (j - 1) >= n2) j--;
+        count += j;
+    }
+    return count;
+}
+
+static_assert(count_lattice_points(16) == lattice_count(16), "16-bit lattice count");
+
+/**
+ * 座標 x, y（BITS ビット整数）が四分円内か（x^2 + y^2 < 2^(2*BITS)）
+ * 
+ * BITS = 32 では x^2, y^2 はそれぞれ 2^64 未満なので、和が 2^64 以上になるのは
+ * 64ビット加算が桁あふれするときだけ（和を 2^64 で割った余りが x^2 より小さくなる）。
+ * 128ビット演算なしで正確に判定できる。
+ */
+template <int BITS>
+constexpr uint64_t packed_inside(uint64_t x, uint64_t y) {
+    if constexpr (BITS == 32) {
+        uint64_t x2 = x * x;
+        return x2 + y * y >= x2;
+    } else {
+        return x * x + y * y < (1ULL << (2 * BITS));
+    }
+}
+
+/**
+ * 1グループ（DRAWS_PER_GROUP 個の乱数）のサンプル from..to-1 を判定
+ */
+template <int BITS>
+inline uint64_t count_group(const uint64_t *draws, int from, int to) {
+    using Tier = PackedTier<BITS>;
+    constexpr int K = Tier::COORDS_PER_DRAW;
+    uint64_t inside = 0;
+    for (int s = from; s < to; s++) {
+        int cx = 2 * s, cy = 2 * s + 1;
+        uint64_t x = (draws[cx / K] >> (BITS * (cx % K))) & Tier::MASK;
+        uint64_t y = (draws[cy / K] >> (BITS * (cy % K))) & Tier::MASK;
+        inside += packed_inside<BITS>(x, y);
+    }
+    return inside;
+}
+
+/**
+ * 整数版（ビットパック）カーネル: 64ビット乱数から BITS ビット座標を複数切り出して判定
+ * 
+ * 乱数1個あたり最大2サンプル（16ビット）を取り出し、浮動小数点への変換なしで判定する。
+ * 判定ループは整数の乗算・比較だけなのでベクトル化される（32×32→64ビットは vpmuludq）。
+ * 円内の点数から求めた推定値は PI_BIAS だけ大きいので、呼び出し側で
+ * packed_pi_bias(BITS) を引く。
+ * 
+ * @param rng 乱数生成器（グループの先頭にあること）
+ * @param offset 先頭グループの中で最初に判定するサンプル番号（0 .. SAMPLES_PER_GROUP-1）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <int BITS, class Engine>
+inline uint64_t count_inside_packed(Engine &rng, uint64_t offset, uint64_t n) {
+    using Tier = PackedTier<BITS>;
+    constexpr int G = Tier::DRAWS_PER_GROUP;
+    constexpr int S = Tier::SAMPLES_PER_GROUP;
+    alignas(64) uint64_t buffer[BLOCK_WORDS];
+    uint64_t group[G];
+    uint64_t inside_circle = 0;
+    
+    // 先頭の端数グループ（並列版のチャンクがグループの途中から始まる場合）
+    if (offset > 0 && n > 0) {
+        rng.fill(group, G);
+        uint64_t to = (offset + n < (uint64_t)S) ? offset + n : S;
+        inside_circle += count_group<BITS>(group, (int)offset, (int)to);
+        n -= to - offset;
+    }
+    
+    while (n >= (uint64_t)S) {
+        size_t groups = (n / S < BLOCK_WORDS / G) ? (size_t)(n / S) : BLOCK_WORDS / G;
+        rng.fill(buffer, groups * G);
+        
+        uint64_t block_inside = 0;
+        for (size_t g = 0; g < groups; g++) {
+            block_inside += count_group<BITS>(&buffer[g * G], 0, S);
+        }
+        inside_circle += block_inside;
+        n -= groups * S;
+    }
+    
+    // 末尾の端数グループ
+    if (n > 0) {
+        rng.fill(group, G);
+        inside_circle += count_group<BITS>(group, 0, (int)n);
+    }
+    
+    return inside_circle;
+}
+
+/**
+ * 単精度版カーネル（1サンプル = 乱数1個、座標は24ビット仮数の float）
+ *
+ * 倍精度では AVX2 で4レーン、AVX-512 で8レーンしか並ばないので、
+ * next() の上位・下位32ビットから x, y を float で作り、8レーン（AVX2）・
+ * 16レーン（AVX-512）で比較する:
+ *   x = (上位32ビット >> 8) * 2^-24,  y = (下位32ビット >> 8) * 2^-24
+ * 変換は整数→float が正確（2^24 未満）なので、fma(x, x, y*y) <= 1.0f の判定だけが
+ * 単精度で丸められる。x*x + y*y のままだと -march=native では FMA に縮約されるかが
+ * コンパイラ・ビルドで変わるので、SIMD版（_mm*_fmadd_ps）もスカラー版（端数・AVXなしビルド、
+ * std::fma）も FMA を明示して丸めを固定する。FMA 命令のないビルドの std::fma は
+ * ライブラリの正しく丸めた実装なので、点数はビルドによらず一致する。
+ *
+ * 座標は 2^24 × 2^24 の格子点で、判定も単精度なので、期待値は π からずれる。
+ * その量 FLOAT_PI_BIAS = 4C / 2^48 - π（約 4.3e-7、うち格子の分が約 2.4e-7、
+ * 単精度の丸めの分が約 1.9e-7）を推定値から引く。C は判定を満たす格子点 (i, j) の数で、
+ * 判定が j について単調なことを使い、各行 i の境界を float_inside() で二分探索して数えた定数
+ * （count_float_lattice_points()、make check-cpp が数え直す）。
+ * 10^11 サンプルでも標準誤差（約 5.2e-6）の1割に満たない。
+ */
+constexpr uint64_t FLOAT_LATTICE_COUNT = 221069959703815ULL;
+
+constexpr double float_pi_bias() {
+    const long double pi = 3.141592653589793238462643383279502884L;
+    return (double)(4.0L * (long double)FLOAT_LATTICE_COUNT / 281474976710656.0L - pi);
+}
+
+// 単精度版の SIMD 幅（JSON の float_lanes、AVX2 のパスは FMA も必要）
+#if defined(__AVX512F__)
+constexpr int FLOAT_LANES = 16;
+#elif defined(__AVX2__) && defined(__FMA__)
+constexpr int FLOAT_LANES = 8;
+#else
+constexpr int FLOAT_LANES = 1;
+#endif
+
+/**
+ * 乱数1個（上位32ビット = x、下位32ビット = y）の点が四分円内か（スカラー版の判定）
+ */
+inline bool float_inside(uint64_t word) {
+    float x = (float)(uint32_t)(word >> 40) * 0x1p-24f;
+    float y = (float)((uint32_t)word >> 8) * 0x1p-24f;
+    return std::fma(x, x, y * y) <= 1.0f;
+}
+
+/**
+ * 判定を満たす格子点の数え上げ（FLOAT_LATTICE_COUNT の検証用、2^24 行 × 24 回の二分探索）
+ *
+ * 行 i（x = i * 2^-24）で y を増やすと fma(x, x, y*y) は減らないので、
+ * 判定を満たす j は [0, 行の境界) になる。境界を float_inside() の二分探索で求める
+ */
+inline uint64_t count_float_lattice_points() {
+    const uint64_t n = 1ULL << 24;
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        uint64_t lo = 0, hi = n;  // 境界は [lo, hi] にある
+        while (lo < hi) {
+            uint64_t mid = (lo + hi) / 2;
+            if (float_inside((i << 40) | (mid << 8))) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        count += lo;
+    }
+    return count;
+}
+
+/**
+ * 乱数 n 個（n サンプル）を単精度で判定
+ *
+ * 64ビット語を32ビット2つとして読み、shuffle_ps で偶数番目（下位 = y）と
+ * 奇数番目（上位 = x）に分ける（128ビットレーン内の並びは x, y で同じなので、
+ * 対応はそのまま保たれる）。
+ *
+ * @param words 乱数（fill() の出力）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+inline uint64_t count_float_words(const uint64_t *words, size_t n) {
+    uint64_t inside_circle = 0;
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512 scale = _mm512_set1_ps(0x1p-24f);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    for (; i + 16 <= n; i += 16) {
+        __m512 a = _mm512_castsi512_ps(_mm512_loadu_si512(words + i));
+        __m512 b = _mm512_castsi512_ps(_mm512_loadu_si512(words + i + 8));
+        __m512i lo = _mm512_castps_si512(_mm512_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m512i hi = _mm512_castps_si512(_mm512_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m512 x = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(hi, 8)), scale);
+        __m512 y = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(lo, 8)), scale);
+        __m512 d = _mm512_fmadd_ps(x, x, _mm512_mul_ps(y, y));
+        inside_circle += __builtin_popcount(_mm512_cmp_ps_mask(d, one, _CMP_LE_OQ));
+    }
+#elif defined(__AVX2__) && defined(__FMA__)
+    const __m256 scale = _mm256_set1_ps(0x1p-24f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i)));
+        __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i + 4)));
+        __m256i lo = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m256i hi = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(hi, 8)), scale);
+        __m256 y = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(lo, 8)), scale);
+        __m256 d = _mm256_fmadd_ps(x, x, _mm256_mul_ps(y, y));
+        inside_circle += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(d, one, _CMP_LE_OQ)));
+    }
+#endif
+    for (; i < n; i++) {
+        inside_circle += float_inside(words[i]);
+    }
+    return inside_circle;
+}
+
+/**
+ * 単精度版カーネル: fill() で整数のまま受け取り、FLOAT_LANES 幅で判定
+ *
+ * 推定値からは float_pi_bias() を引く。
+ *
+ * @param rng 乱数生成器（n 個分進む）
+ * @param n サンプル数
+ * @return 円内の点数
+ */
+template <class Engine>
+inline uint64_t count_inside_float(Engine &rng, uint64_t n) {
+    alignas(64) uint64_t buffer[BLOCK_WORDS];
+    uint64_t inside_circle = 0;
+
+    while (n > 0) {
+        size_t samples = (n < BLOCK_WORDS) ? (size_t)n : BLOCK_WORDS;
+        rng.fill(buffer, samples);
+        inside_circle += count_float_words(buffer, samples);
+        n -= samples;
+    }
+
+    return inside_circle;
+}
+
+#endif /* PI_KERNELS_HPP */
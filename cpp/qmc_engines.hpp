@@ -0,0 +1,268 @@
+#ifndef QMC_ENGINES_HPP
+#define QMC_ENGINES_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include "xoshiro256.hpp"
+#include "engines.hpp"
+
+/**
+ * 準モンテカルロ（QMC）用の2次元低食い違い列（Sobol 列、R2 列）
+ *
+ * アルゴリズムの背景:
+ * - 乱数列の誤差は N^(-1/2) でしか減らないが、低食い違い列は [0, 1)^2 を規則的に埋めるので
+ *   円のような境界のある領域でも誤差がおおむね N^(-3/4) 程度で減る
+ * - 列そのものは決定的なので、ランダムなスクランブルをかけた独立な複製を何本か走らせ、
+ *   複製間のばらつきから誤差を見積もる（--scrambles、bench_options.hpp）
+ *
+ * next() は点 (x, y) の座標を x, y の順に交互に返すので、エンジンの要件（engines.hpp）を満たし、
+ * next_double() を2回ずつ呼ぶカーネル・推定量がそのまま使える。
+ * 1語を複数の座標に切り出す整数版・単精度版カーネルや、1サンプル = 乱数1個の条件付き推定量は
+ * 次元がずれるので使えない（EngineEntry::point_pairs、engine_registry.hpp）。
+ */
+
+/**
+ * Sobol 列の方向数（V_k を64ビットの固定小数点で持つ）
+ */
+struct SobolDirections {
+    uint64_t x[64];  // 第1次元の V_(k+1)
+    uint64_t y[64];  // 第2次元の V_(k+1)
+};
+
+constexpr SobolDirections make_sobol_directions() {
+    SobolDirections d{};
+    uint64_t v = 1ULL << 63;
+    for (int k = 0; k < 64; k++) {
+        d.x[k] = 1ULL << (63 - k);
+        d.y[k] = v;
+        v ^= v >> 1;
+    }
+    return d;
+}
+
+inline constexpr SobolDirections SOBOL_DIRECTIONS = make_sobol_directions();
+
+/**
+ * 2次元 Sobol 列（Gray code 順、ディジタルシフトでスクランブル）
+ *
+ * 第1次元は van der Corput 列（方向数 V_k = 2^(64-k)）、第2次元は原始多項式 x + 1
+ * （m_1 = 1、V_k = V_(k-1) ^ (V_(k-1) >> 1)）で、Joe-Kuo の方向数の先頭2次元と同じ。
+ * 点 n の座標は Gray code G(n) = n ^ (n >> 1) の立っているビットの方向数の XOR なので、
+ * 点 n - 1 から点 n へは V_(ctz(n)+1) を各座標に1回 XOR するだけで進む。
+ * discard() は G(n) から直接計算する（最大64回の XOR）ので、並列版の各スレッドは
+ * 担当区間の先頭の点から始められる。
+ *
+ * スクランブルはシードから作った64ビットの定数を各座標に XOR するディジタルシフト。
+ * 点の集合の (t, m, s) ネットの性質を保ったまま、各点が [0, 1)^2 上で一様分布になるので、
+ * シードの違う複製の推定値は独立で不偏になる。
+ */
+class Sobol2D : public EngineBase<Sobol2D> {
+private:
+    uint64_t shift_x, shift_y;  // ディジタルシフト
+    uint64_t index;             // 次に返す点の番号
+    uint64_t x, y;              // 点 index の座標（シフト前）
+    bool odd;                   // x を返し終えて y を返す番か
+
+    /**
+     * 点 n の座標を Gray code から直接計算
+     */
+    constexpr void seek(uint64_t n) {
+        index = n;
+        x = 0;
+        y = 0;
+        uint64_t gray = n ^ (n >> 1);
+        for (int k = 0; gray != 0; k++, gray >>= 1) {
+            if (gray & 1) {
+                x ^= SOBOL_DIRECTIONS.x[k];
+                y ^= SOBOL_DIRECTIONS.y[k];
+            }
+        }
+    }
+
+    /**
+     * 次の点へ（Gray code の変化するビット ctz(n) の方向数を XOR）
+     */
+    constexpr void advance() {
+        int k = __builtin_ctzll(++index);
+        x ^= SOBOL_DIRECTIONS.x[k];
+        y ^= SOBOL_DIRECTIONS.y[k];
+    }
+
+public:
+    constexpr explicit Sobol2D(uint64_t seed) : Sobol2D(0, 0) {
+        SplitMix64 sm(seed);
+        shift_x = sm.next();
+        shift_y = sm.next();
+    }
+
+    /**
+     * シフトを直接指定（0, 0 ならスクランブルなしの Sobol 列）
+     */
+    constexpr Sobol2D(uint64_t sx, uint64_t sy) : shift_x(sx), shift_y(sy), index(0), x(0), y(0), odd(false) {}
+
+    constexpr uint64_t next() {
+        if (!odd) {
+            odd = true;
+            return x ^ shift_x;
+        }
+        odd = false;
+        uint64_t out = y ^ shift_y;
+        advance();
+        return out;
+    }
+
+    /**
+     * n 個まとめて生成（点単位のループで、1点あたり XOR 2回と ctz 1回）
+     */
+    inline void fill_double(double *out, size_t n) {
+        size_t i = 0;
+        if (odd && n > 0) out[i++] = u64_to_double(next());
+        const uint64_t sx = shift_x, sy = shift_y;
+        for (; i + 2 <= n; i += 2) {
+            out[i] = u64_to_double(x ^ sx);
+            out[i + 1] = u64_to_double(y ^ sy);
+            advance();
+        }
+        if (i < n) out[i] = u64_to_double(next());
+    }
+
+    /**
+     * next() を n 回呼んだのと同じ位置へ（点の番号から直接計算）
+     */
+    constexpr void discard(uint64_t n) {
+        uint64_t position = 2 * index + (odd ? 1 : 0) + n;
+        seek(position / 2);
+        odd = (position % 2) != 0;
+    }
+};
+
+/**
+ * R2 列（一般化黄金比による2次元 Kronecker 列、Roberts 2018）
+ *
+ * 点 n = (frac(s_x + n α_1), frac(s_y + n α_2))、α_1 = 1/φ_2、α_2 = 1/φ_2^2
+ * （φ_2 ≈ 1.3247 は x^3 = x + 1 の実根、plastic number）。
+ * 座標を64ビットの固定小数点 [0, 2^64) で持つと frac は整数の桁あふれそのものなので、
+ * 次の点へは各座標に加算1回で進む。点 n も乗算1回で直接計算でき、discard() は O(1)。
+ *
+ * fill_double() / fill() は4点（8語）ずつ、ブロックの先頭 + 定数の加算で座標を作るので、
+ * 生成はほぼ変換と書き込みだけのベクトル化されたループになる。
+ * スクランブルはシードから作ったランダムシフト（s_x, s_y、Cranley-Patterson 回転）で、
+ * シードの違う複製の推定値は独立で不偏になる。
+ */
+class R2Sequence : public EngineBase<R2Sequence> {
+public:
+    static constexpr uint64_t ALPHA_X = 0xC13FA9A902A6328FULL;  // round(2^64 / φ_2)
+    static constexpr uint64_t ALPHA_Y = 0x91E10DA5C79E7B1DULL;  // round(2^64 / φ_2^2)
+
+private:
+    uint64_t x, y;  // 次に返す点の座標（シフト込み）
+    bool odd;       // x を返し終えて y を返す番か
+
+    /**
+     * points 個の点の座標を out に x, y の順で書き、状態を進める
+     *
+     * BLOCK 点ごとに先頭の座標だけをスカラーの加算で進め、ブロック内の点は
+     * 先頭 + 定数 l α（l < BLOCK）なので、内側のループはレーンごとに加算1回のベクトル演算になる
+     */
+    template <class Out, class Convert>
+    inline void fill_points(Out *out, size_t points, Convert convert) {
+        constexpr size_t BLOCK = 4;
+        uint64_t bx = x, by = y;
+        size_t k = 0;
+        for (; k + BLOCK <= points; k += BLOCK) {
+            for (size_t l = 0; l < BLOCK; l++) {
+                out[2 * (k + l)] = convert(bx + l * ALPHA_X);
+                out[2 * (k + l) + 1] = convert(by + l * ALPHA_Y);
+            }
+            bx += BLOCK * ALPHA_X;
+            by += BLOCK * ALPHA_Y;
+        }
+        for (size_t l = 0; k < points; k++, l++) {
+            out[2 * k] = convert(bx + l * ALPHA_X);
+            out[2 * k + 1] = convert(by + l * ALPHA_Y);
+        }
+        x += points * ALPHA_X;
+        y += points * ALPHA_Y;
+    }
+
+    template <class Out, class Convert>
+    inline void fill_with(Out *out, size_t n, Convert convert) {
+        size_t i = 0;
+        if (odd && n > 0) out[i++] = convert(next());
+        size_t points = (n - i) / 2;
+        fill_points(out + i, points, convert);
+        i += 2 * points;
+        if (i < n) out[i] = convert(next());
+    }
+
+public:
+    constexpr explicit R2Sequence(uint64_t seed) : R2Sequence(0, 0) {
+        SplitMix64 sm(seed);
+        x = sm.next();
+        y = sm.next();
+    }
+
+    /**
+     * シフトを直接指定（0, 0 ならシフトなしの R2 列）
+     */
+    constexpr R2Sequence(uint64_t shift_x, uint64_t shift_y) : x(shift_x), y(shift_y), odd(false) {}
+
+    constexpr uint64_t next() {
+        if (!odd) {
+            odd = true;
+            return x;
+        }
+        odd = false;
+        uint64_t out = y;
+        x += ALPHA_X;
+        y += ALPHA_Y;
+        return out;
+    }
+
+    inline void fill_double(double *out, size_t n) {
+        fill_with(out, n, [](uint64_t v) { return u64_to_double(v); });
+    }
+
+    inline void fill(uint64_t *out, size_t n) {
+        fill_with(out, n, [](uint64_t v) { return v; });
+    }
+
+    /**
+     * next() を n 回呼んだのと同じ位置へ（点の数 × α を足すだけ）
+     */
+    constexpr void discard(uint64_t n) {
+        uint64_t position = (odd ? 1 : 0) + n;
+        x += (position / 2) * ALPHA_X;
+        y += (position / 2) * ALPHA_Y;
+        odd = (position % 2) != 0;
+    }
+};
+
+namespace engines_detail {
+
+// スクランブルなしの先頭の点 (0, 0), (1/2, 1/2), (3/4, 1/4), (1/4, 3/4)
+static_assert(nth_output(Sobol2D(0, 0), 2) == 1ULL << 63 && nth_output(Sobol2D(0, 0), 3) == 1ULL << 63,
+              "Sobol2D point 1");
+static_assert(nth_output(Sobol2D(0, 0), 4) == 3ULL << 62 && nth_output(Sobol2D(0, 0), 5) == 1ULL << 62,
+              "Sobol2D point 2");
+static_assert(nth_output(Sobol2D(0, 0), 6) == 1ULL << 62 && nth_output(Sobol2D(0, 0), 7) == 3ULL << 62,
+              "Sobol2D point 3");
+// 逐次生成と直接計算 discard() が同じ値になること（点の途中からも）
+static_assert(nth_output_after_discard(Sobol2D(7), 1001) == nth_output(Sobol2D(7), 1001), "Sobol2D discard");
+static_assert(nth_output_after_discard(Sobol2D(7), 1000) == nth_output(Sobol2D(7), 1000), "Sobol2D discard");
+
+// α_2 = α_1^2（φ_2 の定義 x^3 = x + 1 から）、点 n = n α
+static_assert((double)R2Sequence::ALPHA_X * (double)R2Sequence::ALPHA_X / 18446744073709551616.0 -
+                          (double)R2Sequence::ALPHA_Y <
+                      4096.0 &&
+                  (double)R2Sequence::ALPHA_Y -
+                          (double)R2Sequence::ALPHA_X * (double)R2Sequence::ALPHA_X / 18446744073709551616.0 <
+                      4096.0,
+              "R2Sequence alpha");
+static_assert(nth_output(R2Sequence(0, 0), 6) == 3 * R2Sequence::ALPHA_X, "R2Sequence point 3");
+static_assert(nth_output_after_discard(R2Sequence(7), 1001) == nth_output(R2Sequence(7), 1001), "R2Sequence discard");
+static_assert(nth_output_after_discard(R2Sequence(7), 1000) == nth_output(R2Sequence(7), 1000), "R2Sequence discard");
+
+}  // namespace engines_detail
+
+#endif /* QMC_ENGINES_HPP */
@@ -0,0 +1,381 @@
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "xoshiro256_simd.hpp"
+#include "engine_registry.hpp"
+#include "bench_options.hpp"
+
+/**
+ * C++版の実行時の自己検査（make check-cpp）
+ *
+ * static_assert で確かめられない性質（大きな試行回数の分割、実行時に選ぶ経路）を確かめ、
+ * 食い違いがあれば NG を出して終了コード1で終わる。
+ *
+ * - 系列の分割: 並列版のスレッドの区間・目標精度モードのチャンクの割り当てのように系列を
+ *   どこで区切っても、レジストリの全エンジン・推定量・カーネルでシングルスレッド版と同じ結果になる
+ * - ChaCha: エンジンが使う SSE2/AVX2 の複数ブロック版（縦に並べたレーンの並べ替え）が
+ *   既知解で検証済みのスカラー版のブロックと一致する
+ * - dSFMT: エンジンが使う SSE2 版の gen_rand_all（lung のシャッフル）が
+ *   既知解で検証済みのスカラー版と同じ状態を作る
+ * - SIMD版 Xoshiro256: Xoshiro256x4 / Xoshiro256x8 のレーン i が、ルート状態を i 回 jump() した
+ *   スカラー版と同じ next() / next_double() を返す（CPU が対応している命令セットだけ）
+ * - 格子の定数: 整数版の lattice_count()（16ビットは static_assert 済み）と単精度版の
+ *   FLOAT_LATTICE_COUNT を数え直す（32ビットの数え上げが数十秒かかる）
+ */
+
+namespace {
+
+// シード（ドライバの既定値と同じ）
+constexpr uint64_t SEED = 12345;
+
+// 食い違いの数
+int failures = 0;
+
+/**
+ * 検査結果を記録（NG なら内容を出す）
+ */
+void expect(bool ok, const std::string &what) {
+    if (ok) return;
+    std::cout << "NG: " << what << "\n";
+    failures++;
+}
+
+/**
+ * 推定量・カーネルの組み合わせの名前（NG の表示用）
+ */
+std::string config_name(const EngineEntry &engine, const KernelConfig &config) {
+    std::string name = std::string(engine.name) + " " + estimator_name(config.estimator);
+    if (config.estimator == Estimator::HitMiss) name += std::string(" ") + kernel_variant(config.kernel);
+    return name;
+}
+
+/**
+ * ドライバが受け付ける組み合わせか（check_kernel_engine / check_estimator_engine と同じ条件）
+ */
+bool config_supported(const EngineEntry &engine, const KernelConfig &config) {
+    if (config.estimator == Estimator::HitMiss) {
+        return !(kernel_uses_raw_words(config.kernel) && (engine.output_bits < 64 || engine.point_pairs));
+    }
+    return !(config.estimator == Estimator::Conditional && engine.point_pairs);
+}
+
+/**
+ * 2つの Moments が一致するか
+ *
+ * サンプル値が 0, 2, 4 のような整数の推定量は和も正確なので完全に一致する。
+ * 条件付き（sqrt の値）と層別（層内の分散）は区切り方で足す順序が変わるので、相対誤差 1e-12 まで許す
+ */
+bool same_moments(const Moments &a, const Moments &b, bool exact) {
+    auto close = [exact](double x, double y) {
+        if (exact) return x == y;
+        return std::abs(x - y) <= 1e-12 * std::max(1.0, std::abs(x));
+    };
+    return a.n == b.n && close(a.sum, b.sum) && close(a.sum_sq, b.sum_sq) && close(a.within_sq, b.within_sq) &&
+           close(a.control_sum, b.control_sum) && close(a.control_sum_sq, b.control_sum_sq) &&
+           close(a.cross_sum, b.cross_sum);
+}
+
+/**
+ * 決まったチャンクだけを順に渡す ChunkQueue（他のスレッドが間のチャンクを取った状態を再現）
+ */
+class FixedChunkQueue : public ChunkQueue {
+public:
+    FixedChunkQueue(std::vector<uint64_t> chunk_list, uint64_t total) : chunks(chunk_list), max_iterations(total) {}
+
+    bool claim(uint64_t &first_sample, uint64_t &n) override {
+        if (next >= chunks.size()) return false;
+        first_sample = chunks[next++] * CHUNK_SAMPLES;
+        n = std::min(CHUNK_SAMPLES, max_iterations - first_sample);
+        return true;
+    }
+
+    void publish(const Moments &moments, const StreamingStats &) override { results.push_back(moments); }
+
+    std::vector<Moments> results;  // 渡したチャンクの順の結果
+
+private:
+    std::vector<uint64_t> chunks;
+    uint64_t max_iterations;
+    size_t next = 0;
+};
+
+/**
+ * 全エンジン × 推定量・カーネルで、区切った推定の和が区切らない推定と一致するか
+ *
+ * estimate は先頭から n サンプルを一度に求めた結果と、グループやチャンクの途中を含む
+ * 任意の位置で区切った区間の和を比べる（並列版のスレッドの区間）。
+ * estimate_chunks はチャンク 1 と 3（端数）だけを取らせ、間を discard した結果を
+ * 同じ区間の estimate と比べる（目標精度モード）。
+ *
+ * @return 比べた組み合わせの数
+ */
+int check_registry_split() {
+    CellBitmap bitmap(8, false);
+    std::vector<KernelConfig> configs;
+    for (int k = (int)Kernel::Scalar; k <= (int)Kernel::Bitmap; k++) {
+        KernelConfig config;
+        config.kernel = (Kernel)k;
+        config.bitmap = &bitmap;
+        configs.push_back(config);
+    }
+    for (Estimator estimator : {Estimator::Conditional, Estimator::Antithetic, Estimator::Stratified,
+                                Estimator::ControlVariate}) {
+        KernelConfig config;
+        config.estimator = estimator;
+        configs.push_back(config);
+    }
+    // 層別は境界セルがチャンク（CHUNK_SAMPLES / m セル）をまたぐ大きさにする
+    const StrataLayout strata = make_strata_layout(0, 2, 2 * CHUNK_SAMPLES);
+    const ControlPolygon control = make_control_polygon(64);
+
+    int combinations = 0;
+    for (const EngineEntry &engine : ENGINE_REGISTRY) {
+        for (KernelConfig config : configs) {
+            if (!config_supported(engine, config)) continue;
+            config.strata = strata;
+            config.control = control;
+            const bool exact = config.estimator != Estimator::Conditional && config.estimator != Estimator::Stratified;
+            const std::string name = config_name(engine, config);
+            combinations++;
+
+            // 先頭のサンプル・グループの途中・チャンクをまたぐ区間で区切る
+            const uint64_t n = (config.estimator == Estimator::Stratified) ? strata.samples() : CHUNK_SAMPLES + 5003;
+            const uint64_t splits[] = {0, 1, 12345, n / 2 + 7, n};
+            StreamingStats stats;
+            Moments whole = engine.estimate(SEED, 0, n, config, stats);
+            Moments parts;
+            for (size_t i = 0; i + 1 < sizeof(splits) / sizeof(splits[0]); i++) {
+                parts.add(engine.estimate(SEED, splits[i], splits[i + 1] - splits[i], config, stats));
+            }
+            expect(same_moments(whole, parts, exact), name + ": split estimate differs from the whole range");
+
+            if (config.estimator == Estimator::Stratified) continue;  // 目標精度モードでは使えない
+            FixedChunkQueue queue({1, 3}, 3 * CHUNK_SAMPLES + 5003);
+            engine.estimate_chunks(SEED, config, queue);
+            Moments first = engine.estimate(SEED, CHUNK_SAMPLES, CHUNK_SAMPLES, config, stats);
+            Moments last = engine.estimate(SEED, 3 * CHUNK_SAMPLES, 5003, config, stats);
+            expect(queue.results.size() == 2 && same_moments(queue.results[0], first, true) &&
+                       same_moments(queue.results[1], last, true),
+                   name + ": estimate_chunks differs from estimate over the same chunks");
+        }
+    }
+    return combinations;
+}
+
+// ChaCha の検査に使う先頭ブロックのカウンタ（下位32ビットの桁上がり・64ビットの折り返しをまたぐもの）
+constexpr uint64_t CHACHA_FIRST_BLOCKS[] = {0, 1, (1ULL << 32) - 3, ~0ULL - 4};
+
+/**
+ * Ops の Ops::LANES ブロックがスカラー版の各ブロックと一致するか
+ */
+template <class Ops, int ROUNDS>
+bool chacha_ops_match(const uint32_t key[8], uint64_t first_block, uint64_t nonce) {
+    constexpr int L = Ops::LANES;
+    alignas(64) uint32_t lanes[16 * L];
+    chacha_blocks<Ops, ROUNDS>(key, first_block, nonce, lanes);
+    for (int b = 0; b < L; b++) {
+        uint32_t block[16];
+        chacha_blocks<ChaChaScalarOps, ROUNDS>(key, first_block + b, nonce, block);
+        for (int k = 0; k < 16; k++) {
+            if (lanes[k * L + b] != block[k]) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * ChaCha<ROUNDS>::generate_batch と SIMD 版のブロックをスカラー版と比べる
+ */
+template <int ROUNDS>
+void check_chacha_rounds() {
+    using Engine = ChaCha<ROUNDS>;
+    SplitMix64 sm(SEED);
+    uint32_t key[8];
+    for (int i = 0; i < 4; i++) {
+        uint64_t k = sm.next();
+        key[2 * i] = (uint32_t)k;
+        key[2 * i + 1] = (uint32_t)(k >> 32);
+    }
+    const std::string name = "ChaCha" + std::to_string(ROUNDS);
+
+    for (uint64_t first_block : CHACHA_FIRST_BLOCKS) {
+        for (uint64_t nonce : {0ULL, 0x0123456789ABCDEFULL}) {
+            const std::string where = name + " block " + std::to_string(first_block) + " nonce " + std::to_string(nonce);
+
+            // generate_batch（BatchOps）と BATCH_BLOCKS 個のスカラー版のブロック
+            uint64_t batch[Engine::BATCH_OUTPUTS];
+            Engine::generate_batch(key, first_block, nonce, batch);
+            bool same = true;
+            for (int b = 0; b < Engine::BATCH_BLOCKS; b++) {
+                uint32_t block[16];
+                chacha_blocks<ChaChaScalarOps, ROUNDS>(key, first_block + b, nonce, block);
+                for (int j = 0; j < Engine::OUTPUTS_PER_BLOCK; j++) {
+                    uint64_t word = block[2 * j] | ((uint64_t)block[2 * j + 1] << 32);
+                    same = same && batch[b * Engine::OUTPUTS_PER_BLOCK + j] == word;
+                }
+            }
+            expect(same, where + ": generate_batch differs from the scalar blocks");
+
+            // ビルドで使える SIMD 版はすべて（AVX2 ビルドでも SSE2 版を）確かめる
+#if defined(__SSE2__)
+            expect(chacha_ops_match<ChaChaSse2Ops, ROUNDS>(key, first_block, nonce),
+                   where + ": SSE2 lanes differ from the scalar blocks");
+#endif
+#if defined(__AVX2__)
+            expect(chacha_ops_match<ChaChaAvx2Ops, ROUNDS>(key, first_block, nonce),
+                   where + ": AVX2 lanes differ from the scalar blocks");
+#endif
+        }
+    }
+}
+
+// dSFMT の検査で状態を再生成する回数（lung が状態全体を何周も伝わる回数）
+constexpr int DSFMT_REGENERATIONS = 16;
+
+/**
+ * gen_rand_all（SSE2 があればベクトル版）と gen_rand_all_scalar で状態を再生成し、毎回比べる
+ */
+void check_dsfmt() {
+    for (uint32_t seed : {0U, (uint32_t)SEED, 0xFFFFFFFFU}) {
+        Dsfmt19937::State vector_state = Dsfmt19937::init_state(seed);
+        Dsfmt19937::State scalar_state = vector_state;
+        for (int r = 0; r < DSFMT_REGENERATIONS; r++) {
+            Dsfmt19937::gen_rand_all(vector_state);
+            Dsfmt19937::gen_rand_all_scalar(scalar_state);
+            if (std::memcmp(&vector_state, &scalar_state, sizeof(Dsfmt19937::State)) != 0) {
+                expect(false, "dSFMT seed " + std::to_string(seed) + ": gen_rand_all differs from the scalar "
+                              "recursion after " + std::to_string(r + 1) + " regeneration(s)");
+                break;
+            }
+        }
+    }
+}
+
+// SIMD版 Xoshiro256 の検査で比べる1レーンあたりの乱数の数（next() と next_double() を交互に）
+constexpr int SIMD_LANE_STEPS = 1000;
+
+#if defined(PI_SIMD_DISPATCH)
+/**
+ * Xoshiro256x4 の出力をレーンごとに書き出す（words[i * 4 + lane]、偶数番目は next()、奇数番目は next_double()）
+ */
+PI_TARGET_AVX2 void xoshiro256x4_outputs(uint64_t seed, uint64_t *words, double *doubles) {
+    Xoshiro256x4 rng{Xoshiro256(seed)};
+    for (int i = 0; i < SIMD_LANE_STEPS; i += 2) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&words[i * 4]), rng.next());
+        _mm256_storeu_pd(&doubles[(i + 1) * 4], rng.next_double());
+    }
+}
+
+/**
+ * Xoshiro256x8 の出力をレーンごとに書き出す（words[i * 8 + lane]、偶数番目は next()、奇数番目は next_double()）
+ */
+PI_TARGET_AVX512 void xoshiro256x8_outputs(uint64_t seed, uint64_t *words, double *doubles) {
+    Xoshiro256x8 rng{Xoshiro256(seed)};
+    for (int i = 0; i < SIMD_LANE_STEPS; i += 2) {
+        _mm512_storeu_si512(&words[i * 8], rng.next());
+        _mm512_storeu_pd(&doubles[(i + 1) * 8], rng.next_double());
+    }
+}
+#endif /* PI_SIMD_DISPATCH */
+
+/**
+ * レーンごとの出力を、ルート状態を lane 回 jump() したスカラー版の系列と比べる
+ */
+void check_simd_lanes(const char *name, int lanes, const std::vector<uint64_t> &words,
+                      const std::vector<double> &doubles) {
+    Xoshiro256 scalar(SEED);
+    for (int lane = 0; lane < lanes; lane++) {
+        Xoshiro256 rng = scalar;
+        bool same = true;
+        for (int i = 0; i < SIMD_LANE_STEPS; i += 2) {
+            same = same && words[i * lanes + lane] == rng.next();
+            same = same && doubles[(i + 1) * lanes + lane] == rng.next_double();
+        }
+        expect(same, std::string(name) + " lane " + std::to_string(lane) +
+                         " differs from the scalar Xoshiro256 jumped " + std::to_string(lane) + " time(s)");
+        scalar.jump();
+    }
+}
+
+/**
+ * CPU が対応している SIMD 版 Xoshiro256 を検査し、検査した版の名前を返す
+ */
+std::string check_xoshiro256_simd() {
+    std::string checked;
+#if defined(PI_SIMD_DISPATCH)
+    if (__builtin_cpu_supports("avx2")) {
+        std::vector<uint64_t> words(SIMD_LANE_STEPS * 4);
+        std::vector<double> doubles(SIMD_LANE_STEPS * 4);
+        xoshiro256x4_outputs(SEED, words.data(), doubles.data());
+        check_simd_lanes("Xoshiro256x4", 4, words, doubles);
+        checked += " Xoshiro256x4";
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        std::vector<uint64_t> words(SIMD_LANE_STEPS * 8);
+        std::vector<double> doubles(SIMD_LANE_STEPS * 8);
+        xoshiro256x8_outputs(SEED, words.data(), doubles.data());
+        check_simd_lanes("Xoshiro256x8", 8, words, doubles);
+        checked += " Xoshiro256x8";
+    }
+#endif
+    return checked;
+}
+
+/**
+ * 量子化バイアスの定数を数え直して比べる
+ */
+void check_lattice_counts() {
+    for (int bits : {21, 26, 32}) {
+        expect(count_lattice_points(bits) == lattice_count(bits),
+               "lattice_count(" + std::to_string(bits) + ") differs from count_lattice_points()");
+    }
+    expect(count_float_lattice_points() == FLOAT_LATTICE_COUNT,
+           "FLOAT_LATTICE_COUNT differs from count_float_lattice_points()");
+}
+
+}  // namespace
+
+int main() {
+    int combinations = check_registry_split();
+    if (failures == 0) {
+        std::cout << "OK: split and chunked estimates match for " << combinations
+                  << " engine/estimator/kernel combinations\n";
+    }
+
+    int before = failures;
+    check_chacha_rounds<8>();
+    check_chacha_rounds<12>();
+    if (failures == before) {
+        std::cout << "OK: ChaCha8/12 " << ChaCha8::BatchOps::LANES
+                  << "-block SIMD batches match the scalar blocks\n";
+    }
+
+    before = failures;
+    check_dsfmt();
+    if (failures == before) {
+        std::cout << "OK: dSFMT-19937 gen_rand_all matches the scalar recursion over " << DSFMT_REGENERATIONS
+                  << " regenerations\n";
+    }
+
+    before = failures;
+    std::string simd = check_xoshiro256_simd();
+    if (simd.empty()) {
+        std::cout << "SKIP: this CPU supports neither AVX2 nor AVX-512 (F+DQ) Xoshiro256 lanes\n";
+    } else if (failures == before) {
+        std::cout << "OK:" << simd << " lanes match the jumped scalar Xoshiro256\n";
+    }
+
+    before = failures;
+    check_lattice_counts();
+    if (failures == before) {
+        std::cout << "OK: lattice_count(21, 26, 32) and FLOAT_LATTICE_COUNT match a recount\n";
+    }
+
+    if (failures > 0) {
+        std::cout << "NG: " << failures << " check(s) failed\n";
+        return 1;
+    }
+    return 0;
+}
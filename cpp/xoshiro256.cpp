@@ -1,52 +1,105 @@
 #include "xoshiro256.hpp"
+#include "gf2_poly.hpp"
 
-Xoshiro256::Xoshiro256(uint64_t seed) {
+namespace {
+
+/**
+ * 参照実装のジャンプ多項式
+ * JUMP = x^(2^128) mod m(x)、LONG_JUMP = x^(2^192) mod m(x)
+ */
+constexpr uint64_t JUMP[4] = {
+    0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+    0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+};
+constexpr uint64_t LONG_JUMP[4] = {
+    0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL,
+    0x77710069854EE241ULL, 0x39109BB02ACBE635ULL
+};
+
+/**
+ * コンパイル時計算用の状態遷移（出力のスクランブラを除いた線形部分）
+ */
+struct LinearState {
+    uint64_t s[4];
+};
+
+struct LinearStep {
+    constexpr void operator()(LinearState &st) const {
+        uint64_t t = st.s[1] << 17;
+        st.s[2] ^= st.s[0];
+        st.s[3] ^= st.s[1];
+        st.s[1] ^= st.s[2];
+        st.s[0] ^= st.s[3];
+        st.s[2] ^= t;
+        st.s[3] = (st.s[3] << 45) | (st.s[3] >> 19);
+    }
+};
+
+// 状態遷移の最小多項式 m(x)（次数256）
+constexpr Gf2Poly<4> MINIMAL_POLY = gf2_minimal_polynomial<4>(LinearState{{1, 2, 3, 4}}, LinearStep{});
+
+// discard() 用の 2^k 回ジャンプの表（k = 0..63、2KB）
+constexpr Gf2JumpTable<4, 64> POW2_JUMPS = gf2_jump_table<4, 64>(MINIMAL_POLY);
+
+// コンパイル時に求めた多項式が参照実装の定数と一致することを検証
+static_assert(gf2_equal(gf2_x_pow2(128, MINIMAL_POLY), JUMP),
+              "x^(2^128) mod m(x) must match the reference JUMP polynomial");
+static_assert(gf2_equal(gf2_x_pow2(192, MINIMAL_POLY), LONG_JUMP),
+              "x^(2^192) mod m(x) must match the reference LONG_JUMP polynomial");
+
+// これより小さい 2^k は jump_with() より next() を直接呼ぶ方が速い
+constexpr int DIRECT_STEP_BITS = 8;
+
+}  // namespace
+
+void Xoshiro256::jump_with(const uint64_t poly[4]) {
     /**
-     * シードを4つの状態に分散（SplitMix64アルゴリズムの簡易版）
+     * 遷移行列 T の多項式 poly(T) を状態に適用する
+     * poly のビット j が立っていれば、j 回進めた状態をXORで足し込む
      */
-    uint64_t s = seed;
-    
-    // SplitMix64風の初期化
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
     for (int i = 0; i < 4; i++) {
-        s ^= s >> 30;
-        s *= 0xBF58476D1CE4E5B9ULL;
-        s ^= s >> 27;
-        s *= 0x94D049BB133111EBULL;
-        s ^= s >> 31;
-        state[i] = s;
+        for (int b = 0; b < 64; b++) {
+            if (poly[i] & (1ULL << b)) {
+                s0 ^= state[0];
+                s1 ^= state[1];
+                s2 ^= state[2];
+                s3 ^= state[3];
+            }
+            next();
+        }
     }
+    state[0] = s0;
+    state[1] = s1;
+    state[2] = s2;
+    state[3] = s3;
 }
 
-uint64_t Xoshiro256::next() {
+void Xoshiro256::jump() {
     /**
-     * 次の乱数を生成（Xoshiro256**アルゴリズム）
+     * 2^128 回分進める（参照実装の JUMP 多項式）
      */
-    // 結果 = rotl(state[1] * 5, 7) * 9
-    uint64_t result = rotl(state[1] * 5, 7) * 9;
-    
-    // 状態の更新
-    uint64_t t = state[1] << 17;
-    
-    // XOR演算で状態を混合
-    state[2] ^= state[0];
-    state[3] ^= state[1];
-    state[1] ^= state[2];
-    state[0] ^= state[3];
-    
-    state[2] ^= t;
-    
-    // 状態[3] = rotl(state[1], 45)
-    state[3] = rotl(state[1], 45);
-    
-    return result;
+    jump_with(JUMP);
 }
 
-double Xoshiro256::next_double() {
+void Xoshiro256::long_jump() {
     /**
-     * 0.0以上1.0未満の浮動小数点数を生成
+     * 2^192 回分進める（参照実装の LONG_JUMP 多項式）
      */
-    // 64ビット整数を53ビット精度の浮動小数点数に変換
-    // IEEE 754倍精度浮動小数点数の仮数部は52ビット + 1ビットの暗黙の1
-    return (next() >> 11) * (1.0 / (1ULL << 53));
+    jump_with(LONG_JUMP);
 }
 
+void Xoshiro256::discard(uint64_t n) {
+    /**
+     * n 回分進める（n の2進展開に従って 2^k 回ジャンプを合成）
+     * 下位ビットは next() を直接呼び、上位ビットは表の多項式で1回256ステップ
+     */
+    for (uint64_t i = 0; i < (n & ((1ULL << DIRECT_STEP_BITS) - 1)); i++) {
+        next();
+    }
+    for (int k = DIRECT_STEP_BITS; k < 64; k++) {
+        if (n & (1ULL << k)) {
+            jump_with(POW2_JUMPS.pow2[k].words);
+        }
+    }
+}
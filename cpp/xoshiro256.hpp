@@ -2,6 +2,8 @@
 #define XOSHIRO256_HPP
 
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
 
 /**
  * Xoshiro256** - 高速・軽量・高品質な乱数生成器
@@ -22,15 +24,38 @@
  * C++での実装の違い:
  * - uint64_t型を使用、restrictキーワードで最適化（C++では__restrict__）
  * - C++標準ライブラリの活用
+ * - ホットパス（コンストラクタ、next()、next_double()、fill系）はヘッダ内の
+ *   constexpr/inline 定義なので、-flto なしのビルドでも calculate_pi のループに
+ *   インライン展開される。jump() / long_jump() / discard() はループ外でしか
+ *   呼ばれないので xoshiro256.cpp に置く
  */
 
 /**
  * 左ローテーション（ビットを左に回転）
  */
-static inline uint64_t rotl(uint64_t x, int k) {
+constexpr inline uint64_t rotl(uint64_t x, int k) {
     return (x << k) | (x >> (64 - k));
 }
 
+/**
+ * 64ビット乱数の上位53ビットを [0, 1) の倍精度に変換（ビット演算のみ）
+ * 
+ * v = x >> 11 を下位52ビットと最上位ビットに分け、指数部 0x433（= 2^52）を
+ * 埋め込んだビット列から 2^52 を引く。どの項も整数として正確なので
+ * (x >> 11) * 2^-53 と同じ値になり、整数→浮動小数点変換命令を使わないため
+ * AVX2でもベクトル化される。
+ */
+inline double u64_to_double(uint64_t x) {
+    const uint64_t magic = 0x4330000000000000ULL;  // 2^52 のビット表現
+    uint64_t v = x >> 11;
+    uint64_t lo_bits = (v & 0x000FFFFFFFFFFFFFULL) | magic;
+    uint64_t hi_bits = (0 - (v >> 52)) & magic;
+    double lo, hi;
+    std::memcpy(&lo, &lo_bits, sizeof(double));
+    std::memcpy(&hi, &hi_bits, sizeof(double));
+    return ((lo - 4503599627370496.0) + hi) * (1.0 / (1ULL << 53));
+}
+
 /**
  * Xoshiro256**の状態クラス
  */
@@ -38,28 +63,165 @@ class Xoshiro256 {
 private:
     uint64_t state[4];  // 4つの64ビット整数（合計256ビット）
 
+    // fill_double() が一度に生成する整数の個数（スタック上の一時バッファ）
+    static constexpr size_t FILL_CHUNK = 256;
+
+    /**
+     * ジャンプ多項式（GF(2)係数、256ビット）を状態に適用
+     *
+     * @param poly 多項式の係数（4×64ビット、下位ビットが低次）
+     */
+    void jump_with(const uint64_t poly[4]);
+
 public:
     /**
      * シードから初期状態を生成
      * 
      * @param seed 初期シード値
      */
-    explicit Xoshiro256(uint64_t seed);
+    constexpr explicit Xoshiro256(uint64_t seed) : state{0, 0, 0, 0} {
+        /**
+         * シードを4つの状態に分散（SplitMix64アルゴリズムの簡易版）
+         */
+        uint64_t s = seed;
+        
+        // SplitMix64風の初期化
+        for (int i = 0; i < 4; i++) {
+            s ^= s >> 30;
+            s *= 0xBF58476D1CE4E5B9ULL;
+            s ^= s >> 27;
+            s *= 0x94D049BB133111EBULL;
+            s ^= s >> 31;
+            state[i] = s;
+        }
+    }
+
+    /**
+     * 状態を直接指定して初期化（既知解チェック用）
+     */
+    constexpr Xoshiro256(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3)
+        : state{s0, s1, s2, s3} {}
     
     /**
      * 次の乱数を生成（Xoshiro256**アルゴリズム）
      * 
      * @return 64ビットの乱数
      */
-    uint64_t next();
+    constexpr uint64_t next() {
+        // 結果 = rotl(state[1] * 5, 7) * 9
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        
+        // 状態の更新
+        uint64_t t = state[1] << 17;
+        
+        // XOR演算で状態を混合
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        
+        state[2] ^= t;
+        
+        // 状態[3] = rotl(state[3], 45)
+        // 参照実装どおり state[3] 自身をローテートする（state[1] を使うと状態遷移が
+        // 正則でなくなり、周期 2^256-1 も jump() の多項式も成り立たない）
+        state[3] = rotl(state[3], 45);
+        
+        return result;
+    }
     
     /**
      * 0.0以上1.0未満の浮動小数点数を生成
      * 
      * @return 乱数（0.0 <= x < 1.0）
      */
-    double next_double();
+    constexpr double next_double() {
+        // 64ビット整数を53ビット精度の浮動小数点数に変換
+        // IEEE 754倍精度浮動小数点数の仮数部は52ビット + 1ビットの暗黙の1
+        return (next() >> 11) * (1.0 / (1ULL << 53));
+    }
+
+    /**
+     * 64ビット乱数を n 個まとめて生成（next() を n 回呼んだのと同じ系列）
+     *
+     * 状態をローカル変数（レジスタ）に載せたままループするので、
+     * 1値ごとの関数呼び出しと状態の読み書きがなくなる
+     *
+     * @param out 出力先（n 要素）
+     * @param n 生成する個数
+     */
+    inline void fill(uint64_t *out, size_t n) {
+        uint64_t s0 = state[0], s1 = state[1], s2 = state[2], s3 = state[3];
+        for (size_t i = 0; i < n; i++) {
+            out[i] = rotl(s1 * 5, 7) * 9;
+            uint64_t t = s1 << 17;
+            s2 ^= s0;
+            s3 ^= s1;
+            s1 ^= s2;
+            s0 ^= s3;
+            s2 ^= t;
+            s3 = rotl(s3, 45);
+        }
+        state[0] = s0;
+        state[1] = s1;
+        state[2] = s2;
+        state[3] = s3;
+    }
+
+    /**
+     * 0.0以上1.0未満の浮動小数点数を n 個まとめて生成
+     * （next_double() を n 回呼んだのと同じ値）
+     *
+     * 整数をチャンク単位で生成し、別ループでまとめて倍精度に変換する
+     * （変換はベクトル化できるビット演算、u64_to_double() を参照）
+     *
+     * @param out 出力先（n 要素）
+     * @param n 生成する個数
+     */
+    inline void fill_double(double *out, size_t n) {
+        uint64_t raw[FILL_CHUNK];
+        for (size_t done = 0; done < n; done += FILL_CHUNK) {
+            size_t m = (n - done < FILL_CHUNK) ? n - done : FILL_CHUNK;
+            fill(raw, m);
+            for (size_t i = 0; i < m; i++) {
+                out[done + i] = u64_to_double(raw[i]);
+            }
+        }
+    }
+
+    /**
+     * 2^128 回 next() を呼んだのと同じ状態に進める
+     *
+     * 1つのルート状態から jump() を繰り返すと、互いに重ならない
+     * 長さ 2^128 の部分系列（サブストリーム）が 2^128 本得られる
+     */
+    void jump();
+
+    /**
+     * 2^192 回 next() を呼んだのと同じ状態に進める
+     *
+     * スレッドごとのストリーム分割用。各ストリームは内部で
+     * jump() によりさらに 2^64 本のサブストリームに分けられる
+     */
+    void long_jump();
+
+    /**
+     * n 回 next() を呼んだのと同じ状態に進める（O(log n)）
+     *
+     * 任意のサンプル位置から系列を始められるので、並列版でチャンク k を
+     * 逐次実行の k*C 番目の位置から正確に開始できる。
+     * ジャンプ多項式 x^(2^k) mod m(x) はコンパイル時に計算した表を使う。
+     *
+     * @param n 進める回数
+     */
+    void discard(uint64_t n);
+
+    /**
+     * 内部状態への読み取り専用アクセス（SIMD版エンジンのレーン初期化用）
+     *
+     * @return 4要素の状態配列
+     */
+    constexpr const uint64_t *get_state() const { return state; }
 };
 
 #endif /* XOSHIRO256_HPP */
-
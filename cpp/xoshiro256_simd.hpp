@@ -0,0 +1,207 @@
+#ifndef XOSHIRO256_SIMD_HPP
+#define XOSHIRO256_SIMD_HPP
+
+#include <cstdint>
+#include "xoshiro256.hpp"
+
+/**
+ * Xoshiro256** のSIMD版（複数の独立した状態を同時に進める）
+ *
+ * アルゴリズムの背景:
+ * - スカラー版の next() は直列の依存チェーンなので、1サンプルごとに
+ *   十数サイクルのレイテンシを待つことになり、ベクトルユニットが遊ぶ
+ * - 独立した状態をレーン数だけ用意し、SoA（Structure of Arrays）で
+ *   state[0..3] をそれぞれ1本のベクトルレジスタに保持する
+ * - 各レーンはルート状態を jump() で 2^128 ずつ進めたサブストリームで、
+ *   スカラー版 Xoshiro256 とまったく同じ系列を生成する（レーン間の重なりなし）
+ *
+ * AVX2の制約:
+ * - 64ビット整数の乗算・ローテート・符号なし整数→倍精度変換がない
+ * - ×5, ×9 はシフト+加算、rotl はシフト+ORで表現する
+ * - 倍精度変換は指数部のビットトリック（下記 to_double）で行う
+ *
+ * AVX-512の利点:
+ * - 8レーン（ZMMレジスタ）、64ビットローテート命令 vprolq をそのまま使える
+ * - 比較結果がマスクレジスタ（__mmask8）に入るので、movemask不要でpopcountできる
+ *
+ * 実行時の選択:
+ * - メンバ関数は target 属性（PI_TARGET_AVX2 / PI_TARGET_AVX512）でその命令セット向けに
+ *   コンパイルするので、-march=native なしのビルドでも定義される
+ * - 呼び出し側は __builtin_cpu_supports() で CPU が対応しているかを確かめてから使い、
+ *   対応していなければスカラー版に戻す（monte_carlo_single.cpp）
+ */
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PI_SIMD_DISPATCH 1
+#define PI_TARGET_AVX2 __attribute__((target("avx2")))
+#define PI_TARGET_AVX512 __attribute__((target("avx512f,avx512dq")))
+#include <immintrin.h>
+#endif
+
+#if defined(PI_SIMD_DISPATCH)
+
+/**
+ * AVX2版 Xoshiro256**（4レーン、YMMレジスタ）
+ */
+class Xoshiro256x4 {
+private:
+    __m256i s0, s1, s2, s3;  // state[k] の4レーン分（SoA配置）
+
+    PI_TARGET_AVX2 static inline __m256i rotl(__m256i x, int k) {
+        return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+    }
+
+public:
+    /**
+     * ルート状態から4つのサブストリームを生成
+     *
+     * レーン i はルート状態を i 回 jump() した系列になる
+     *
+     * @param root ルート状態
+     */
+    PI_TARGET_AVX2 explicit Xoshiro256x4(Xoshiro256 root) {
+        alignas(32) uint64_t lanes[4][4];
+        for (int i = 0; i < 4; i++) {
+            for (int k = 0; k < 4; k++) {
+                lanes[k][i] = root.get_state()[k];
+            }
+            root.jump();
+        }
+        s0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(lanes[0]));
+        s1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(lanes[1]));
+        s2 = _mm256_load_si256(reinterpret_cast<const __m256i *>(lanes[2]));
+        s3 = _mm256_load_si256(reinterpret_cast<const __m256i *>(lanes[3]));
+    }
+
+    /**
+     * 4レーン分の64ビット乱数を生成
+     *
+     * @return 4つの64ビット乱数
+     */
+    PI_TARGET_AVX2 inline __m256i next() {
+        // 結果 = rotl(state[1] * 5, 7) * 9（乗算はシフト+加算）
+        __m256i x5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+        __m256i r = rotl(x5, 7);
+        __m256i result = _mm256_add_epi64(_mm256_slli_epi64(r, 3), r);
+
+        __m256i t = _mm256_slli_epi64(s1, 17);
+
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+
+        s2 = _mm256_xor_si256(s2, t);
+
+        s3 = rotl(s3, 45);
+
+        return result;
+    }
+
+    /**
+     * 64ビット乱数の上位53ビットを [0, 1) の倍精度に変換
+     *
+     * v = x >> 11（53ビット）を下位52ビットと最上位ビットに分け、
+     * 0x4330000000000000（= 2^52）の指数部を埋め込んで 2^52 を引く。
+     * 各項は整数として正確に表現されるので、スカラー版と同じ値になる。
+     */
+    PI_TARGET_AVX2 static inline __m256d to_double(__m256i x) {
+        const __m256i magic = _mm256_set1_epi64x(0x4330000000000000LL);
+        const __m256i low_mask = _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL);
+        __m256i v = _mm256_srli_epi64(x, 11);
+        __m256d lo = _mm256_sub_pd(
+            _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(v, low_mask), magic)),
+            _mm256_set1_pd(4503599627370496.0));
+        __m256i top = _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_srli_epi64(v, 52));
+        __m256d hi = _mm256_castsi256_pd(_mm256_and_si256(top, magic));
+        return _mm256_mul_pd(_mm256_add_pd(lo, hi), _mm256_set1_pd(1.0 / (1ULL << 53)));
+    }
+
+    /**
+     * 4レーン分の 0.0以上1.0未満の浮動小数点数を生成
+     *
+     * @return 4つの乱数（0.0 <= x < 1.0）
+     */
+    PI_TARGET_AVX2 inline __m256d next_double() {
+        return to_double(next());
+    }
+};
+
+
+/**
+ * AVX-512版 Xoshiro256**（8レーン、ZMMレジスタ）
+ */
+class Xoshiro256x8 {
+private:
+    __m512i s0, s1, s2, s3;  // state[k] の8レーン分（SoA配置）
+
+public:
+    /**
+     * ルート状態から8つのサブストリームを生成
+     *
+     * レーン i はルート状態を i 回 jump() した系列になる
+     *
+     * @param root ルート状態
+     */
+    PI_TARGET_AVX512 explicit Xoshiro256x8(Xoshiro256 root) {
+        alignas(64) uint64_t lanes[4][8];
+        for (int i = 0; i < 8; i++) {
+            for (int k = 0; k < 4; k++) {
+                lanes[k][i] = root.get_state()[k];
+            }
+            root.jump();
+        }
+        s0 = _mm512_load_si512(lanes[0]);
+        s1 = _mm512_load_si512(lanes[1]);
+        s2 = _mm512_load_si512(lanes[2]);
+        s3 = _mm512_load_si512(lanes[3]);
+    }
+
+    /**
+     * 8レーン分の64ビット乱数を生成
+     *
+     * @return 8つの64ビット乱数
+     */
+    PI_TARGET_AVX512 inline __m512i next() {
+        // 結果 = rotl(state[1] * 5, 7) * 9（ローテートは vprolq）
+        __m512i x5 = _mm512_add_epi64(_mm512_slli_epi64(s1, 2), s1);
+        __m512i r = _mm512_rol_epi64(x5, 7);
+        __m512i result = _mm512_add_epi64(_mm512_slli_epi64(r, 3), r);
+
+        __m512i t = _mm512_slli_epi64(s1, 17);
+
+        s2 = _mm512_xor_si512(s2, s0);
+        s3 = _mm512_xor_si512(s3, s1);
+        s1 = _mm512_xor_si512(s1, s2);
+        s0 = _mm512_xor_si512(s0, s3);
+
+        s2 = _mm512_xor_si512(s2, t);
+
+        s3 = _mm512_rol_epi64(s3, 45);
+
+        return result;
+    }
+
+    /**
+     * 64ビット乱数の上位53ビットを [0, 1) の倍精度に変換
+     *
+     * AVX512DQ の vcvtuqq2pd で53ビットの整数を直接変換する（PI_TARGET_AVX512 は DQ も前提にする）
+     */
+    PI_TARGET_AVX512 static inline __m512d to_double(__m512i x) {
+        __m512i v = _mm512_srli_epi64(x, 11);
+        return _mm512_mul_pd(_mm512_cvtepu64_pd(v), _mm512_set1_pd(1.0 / (1ULL << 53)));
+    }
+
+    /**
+     * 8レーン分の 0.0以上1.0未満の浮動小数点数を生成
+     *
+     * @return 8つの乱数（0.0 <= x < 1.0）
+     */
+    PI_TARGET_AVX512 inline __m512d next_double() {
+        return to_double(next());
+    }
+};
+
+#endif /* PI_SIMD_DISPATCH */
+
+#endif /* XOSHIRO256_SIMD_HPP */